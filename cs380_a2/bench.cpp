@@ -0,0 +1,318 @@
+/*!*****************************************************************************
+\file bench.cpp
+\author Chen Yen Hsun
+\par DP email: c.yenhsun\@digipen.edu
+\par Course: CS380
+\par Section: A
+\par Programming Assignment 2
+\date 05-14-2023
+\brief
+
+Benchmark for the flood fill engines. Generates seeded mazes, caves, open
+rooms and spirals and reports filled cells per second and the peak size of
+the open list for every engine.
+
+    usage: bench.out [max size = 1024] [seed = 380]
+
+Copyright (C) 2022 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents
+without the prior written consent of DigiPen Institute of
+Technology is prohibited.
+*******************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include "functions.h"
+
+namespace
+{
+    const int WALL = 1;
+    const int COLOR = 2;
+
+    // Recursion depth grows with the filled area, so the recursive engine is
+    // only timed on maps that fit in a default thread stack
+    const int RECURSIVE_MAX_SIZE = 128;
+
+    using Map = std::vector<int>;
+
+    /*!*****************************************************************************
+     * \brief
+        Perfect maze carved by a randomized depth-first backtracker. Corridors
+        are one cell wide, so the fill frontier stays small but the path is long.
+    *******************************************************************************/
+    Map makeMaze(int size, unsigned seed)
+    {
+        Map map(static_cast<std::size_t>(size) * size, WALL);
+        std::mt19937 rng{ seed };
+
+        const int cells = (size - 1) / 2; // maze cells per side on odd coordinates
+        std::vector<AI::Key> stack{ AI::Key{ 0, 0 } };
+        std::vector<char> seen(static_cast<std::size_t>(cells) * cells, 0);
+        seen[0] = 1;
+        map[static_cast<std::size_t>(1) * size + 1] = 0;
+
+        const int dj[] = { -1, 1, 0, 0 };
+        const int di[] = { 0, 0, -1, 1 };
+
+        while (!stack.empty())
+        {
+            AI::Key cell = stack.back();
+            int options[4];
+            int count = 0;
+
+            for (int d = 0; d < 4; ++d)
+            {
+                int j = cell.j + dj[d];
+                int i = cell.i + di[d];
+                if (j >= 0 && j < cells && i >= 0 && i < cells && !seen[j * cells + i])
+                    options[count++] = d;
+            }
+
+            if (count == 0)
+            {
+                stack.pop_back();
+                continue;
+            }
+
+            int d = options[rng() % count];
+            AI::Key next{ cell.j + dj[d], cell.i + di[d] };
+            seen[next.j * cells + next.i] = 1;
+
+            // Open the wall between the cells and the new cell itself
+            map[static_cast<std::size_t>(cell.j * 2 + 1 + dj[d]) * size + cell.i * 2 + 1 + di[d]] = 0;
+            map[static_cast<std::size_t>(next.j * 2 + 1) * size + next.i * 2 + 1] = 0;
+            stack.push_back(next);
+        }
+
+        return map;
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Organic caves made by smoothing random noise with a cellular automaton.
+        The filled region has a wide, ragged frontier.
+    *******************************************************************************/
+    Map makeCave(int size, unsigned seed)
+    {
+        Map map(static_cast<std::size_t>(size) * size);
+        std::mt19937 rng{ seed };
+
+        for (auto& cell : map)
+            cell = (rng() % 100 < 45) ? WALL : 0;
+
+        Map next(map.size());
+        for (int step = 0; step < 4; ++step)
+        {
+            for (int j = 0; j < size; ++j)
+                for (int i = 0; i < size; ++i)
+                {
+                    int walls = 0;
+                    for (int y = j - 1; y <= j + 1; ++y)
+                        for (int x = i - 1; x <= i + 1; ++x)
+                            if (y < 0 || y >= size || x < 0 || x >= size
+                                || map[static_cast<std::size_t>(y) * size + x] == WALL)
+                                ++walls;
+                    next[static_cast<std::size_t>(j) * size + i] = (walls >= 5) ? WALL : 0;
+                }
+            map.swap(next);
+        }
+
+        return map;
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Square rooms separated by single walls with one door per wall. Almost
+        every cell is open, which is the worst case for the open list size.
+    *******************************************************************************/
+    Map makeRooms(int size, unsigned seed)
+    {
+        const int ROOM = 16;
+        Map map(static_cast<std::size_t>(size) * size, 0);
+        std::mt19937 rng{ seed };
+
+        for (int k = ROOM; k < size; k += ROOM)
+            for (int t = 0; t < size; ++t)
+            {
+                map[static_cast<std::size_t>(k) * size + t] = WALL;
+                map[static_cast<std::size_t>(t) * size + k] = WALL;
+            }
+
+        // Punch a door into every wall segment between two rooms
+        for (int k = ROOM; k < size; k += ROOM)
+            for (int t = 0; t < size; t += ROOM)
+            {
+                int door = t + static_cast<int>(rng() % (ROOM - 1));
+                if (door < size)
+                {
+                    map[static_cast<std::size_t>(k) * size + door] = 0;
+                    map[static_cast<std::size_t>(door) * size + k] = 0;
+                }
+            }
+
+        return map;
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        A single corridor that winds inwards. The fill becomes one long chain,
+        which is the deepest possible recursion for a given area.
+    *******************************************************************************/
+    Map makeSpiral(int size, unsigned /*seed*/)
+    {
+        Map map(static_cast<std::size_t>(size) * size, WALL);
+        auto carve = [&](int j, int i)
+        {
+            if (j >= 0 && j < size && i >= 0 && i < size)
+                map[static_cast<std::size_t>(j) * size + i] = 0;
+        };
+
+        int top = 0, left = 0, bottom = size - 1, right = size - 1;
+        while (top <= bottom && left <= right)
+        {
+            for (int i = left; i <= right; ++i) carve(top, i);
+            for (int j = top; j <= bottom; ++j) carve(j, right);
+            if (top == bottom || left == right)
+                break;
+            for (int i = right; i >= left; --i) carve(bottom, i);
+            for (int j = bottom; j >= top + 2; --j) carve(j, left);
+
+            // Step into the next ring, leaving a wall between the rings
+            if (top + 2 <= bottom - 2 && left + 2 <= right - 2)
+                carve(top + 2, left + 1);
+            top += 2; left += 2; bottom -= 2; right -= 2;
+        }
+
+        return map;
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Picks the open cell nearest to the map center in scan order so that all
+        engines start from the same seed cell.
+    *******************************************************************************/
+    AI::Key findStart(const Map& map, int size)
+    {
+        for (std::size_t k = static_cast<std::size_t>(size) * size / 2; k < map.size(); ++k)
+            if (map[k] == 0)
+                return AI::Key{ static_cast<int>(k / size), static_cast<int>(k % size) };
+        for (std::size_t k = 0; k < map.size(); ++k)
+            if (map[k] == 0)
+                return AI::Key{ static_cast<int>(k / size), static_cast<int>(k % size) };
+        return AI::Key{ 0, 0 };
+    }
+
+    struct Result
+    {
+        std::size_t filled;
+        double seconds;
+        std::size_t peak;
+        bool hasPeak;
+    };
+
+    // Engines that track their open list report its high-water mark
+    template<typename Engine>
+    bool readPeak(const Engine& engine, std::size_t& peak)
+    {
+        peak = engine.getPeak();
+        return true;
+    }
+
+    bool readPeak(const AI::Flood_Fill_Recursive&, std::size_t&)
+    {
+        return false;
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Fills a copy of the map with one engine and measures it.
+    *******************************************************************************/
+    template<typename Engine, typename GetAdjacents = AI::GetMapAdjacents>
+    Result measure(const Map& source, int size, AI::Key start)
+    {
+        Map map = source;
+        GetAdjacents getAdjacents{ map.data(), size };
+        Engine engine{ &getAdjacents };
+
+        auto begin = std::chrono::steady_clock::now();
+        engine.run(start, COLOR);
+        auto end = std::chrono::steady_clock::now();
+
+        Result result{};
+        for (int cell : map)
+            result.filled += (cell == COLOR);
+        result.seconds = std::chrono::duration<double>(end - begin).count();
+        result.hasPeak = readPeak(engine, result.peak);
+        return result;
+    }
+
+    void report(const char* mapName, int size, const char* engine, const Result& r)
+    {
+        double rate = r.seconds > 0.0 ? r.filled / r.seconds / 1.0e6 : 0.0;
+
+        std::cout << std::left << std::setw(8) << mapName
+            << std::right << std::setw(7) << size
+            << "  " << std::left << std::setw(12) << engine
+            << std::right << std::setw(12) << r.filled
+            << std::setw(12) << std::fixed << std::setprecision(2) << r.seconds * 1000.0
+            << std::setw(12) << std::setprecision(2) << rate;
+        if (r.hasPeak)
+            std::cout << std::setw(12) << r.peak;
+        else
+            std::cout << std::setw(12) << '-';
+        std::cout << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int maxSize = argc > 1 ? std::atoi(argv[1]) : 1024;
+    unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 380u;
+
+    struct Generator
+    {
+        const char* name;
+        Map(*make)(int, unsigned);
+    };
+    const Generator generators[] = {
+        { "maze", makeMaze },
+        { "cave", makeCave },
+        { "rooms", makeRooms },
+        { "spiral", makeSpiral }
+    };
+
+    std::cout << std::left << std::setw(8) << "map"
+        << std::right << std::setw(7) << "size"
+        << "  " << std::left << std::setw(12) << "engine"
+        << std::right << std::setw(12) << "filled"
+        << std::setw(12) << "ms"
+        << std::setw(12) << "Mcells/s"
+        << std::setw(12) << "peak open" << std::endl;
+
+    for (int size = 64; size <= maxSize && size <= 16384; size *= 4)
+    {
+        for (const Generator& generator : generators)
+        {
+            Map map = generator.make(size, seed);
+            AI::Key start = findStart(map, size);
+
+            if (size <= RECURSIVE_MAX_SIZE)
+                report(generator.name, size, "recursive",
+                    measure<AI::Flood_Fill_Recursive>(map, size, start));
+            report(generator.name, size, "explicit",
+                measure<AI::Flood_Fill_Explicit_Stack>(map, size, start));
+            report(generator.name, size, "queue",
+                measure<AI::Flood_Fill_Iterative<AI::Queue>>(map, size, start));
+            report(generator.name, size, "stack",
+                measure<AI::Flood_Fill_Iterative<AI::Stack>>(map, size, start));
+            report(generator.name, size, "stoch-stack",
+                measure<AI::Flood_Fill_Iterative<AI::Stack>, AI::GetMapStochasticAdjacents>(map, size, start));
+        }
+    }
+
+    return 0;
+}
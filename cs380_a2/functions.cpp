@@ -68,18 +68,36 @@ namespace AI
         std::vector<AI::Node*> list = {};
         list = GetMapAdjacents::operator()(key);
 
-        // Find and return all empty adjacent cells
-        // Use the base class operator() and then shuffle the result
-        std::random_shuffle(list.begin(), list.end());
+        // Fisher-Yates over the at most four cells, unrolled over fixed slots.
+        // All three swap positions come from one random number and steps
+        // past the end swap a slot with itself, so there are no branches.
+        Node* slots[4] = {};
+        const std::uint32_t count = static_cast<std::uint32_t>(list.size());
+        std::copy(list.begin(), list.end(), slots);
+
+        std::uint32_t bits = rng();
+        for (std::uint32_t k = 3; k > 0; --k)
+        {
+            std::uint64_t product = static_cast<std::uint64_t>(bits) * (k + 1);
+            std::uint32_t j = static_cast<std::uint32_t>(product >> 32u);
+            bits = static_cast<std::uint32_t>(product);
+            j = k < count ? j : k;
+            std::swap(slots[k], slots[j]);
+        }
 
+        std::copy(slots, slots + count, list.begin());
         return list;
     }
 
     /*!*****************************************************************************
     // Define function for for struct Queue
     *******************************************************************************/
-    void Queue::clear() { p_Node.clear(); }
-    void Queue::push(Node* pNode){ p_Node.emplace_back(pNode); }
+    void Queue::clear() { p_Node.clear(); peak = 0; }
+    void Queue::push(Node* pNode){
+
+        p_Node.emplace_back(pNode);
+        peak = std::max(peak, p_Node.size());
+    }
     Node* Queue::pop(){
 
         Node* pNode = p_Node.front();
@@ -93,8 +111,12 @@ namespace AI
     /*!*****************************************************************************
     // Define function for for struct Stack
     *******************************************************************************/
-    void Stack::clear() { p_Node.clear(); }
-    void Stack::push(Node* pNode) { p_Node.emplace_back(pNode); }
+    void Stack::clear() { p_Node.clear(); peak = 0; }
+    void Stack::push(Node* pNode) {
+
+        p_Node.emplace_back(pNode);
+        peak = std::max(peak, p_Node.size());
+    }
     Node* Stack::pop() {
 
         Node* pNode = p_Node.back();
@@ -129,6 +151,50 @@ namespace AI
     }
 
 
+    /*!*****************************************************************************
+     * \brief
+        Runs the flood fill algorithm with an explicit stack.
+     *
+     * \param key
+        The key of the starting node for flood fill.
+
+     * \param color
+        The color to fill the connected nodes with.
+    *******************************************************************************/
+    void Flood_Fill_Explicit_Stack::run(Key key, int color)
+    {
+        std::size_t top = 0;
+        peak = 0;
+
+        // Same as entering Flood_Fill_Recursive::run(key, color)
+        auto call = [&](Key k)
+        {
+            if (top == frames.size())
+                frames.emplace_back();
+            frames[top].adjacents = pGetAdjacents->operator()(k);
+            frames[top].next = 0;
+            peak = std::max(peak, ++top);
+        };
+
+        call(key);
+
+        while (top)
+        {
+            Frame& frame = frames[top - 1];
+            if (frame.next == frame.adjacents.size())
+            {
+                --top; // return from the call
+                continue;
+            }
+
+            Node* adj = frame.adjacents[frame.next++];
+            *(adj->pValue) = color;
+            Key next = adj->key;
+            delete adj;
+            call(next); // may grow frames, so frame is not used after this
+        }
+    }
+
     /*!*****************************************************************************
      * \brief
         Runs the iterative flood fill algorithm.
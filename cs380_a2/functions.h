@@ -79,6 +79,8 @@ namespace AI
     *******************************************************************************/
     class GetMapStochasticAdjacents : public GetMapAdjacents
     {
+        Random rng; // own stream, so functors on other threads do not interfere
+
     public:
         /*!*****************************************************************************
          * \brief 
@@ -89,9 +91,12 @@ namespace AI
 
          * \param size 
             The width and height of the map in terms of the number of elements.
+
+         * \param rng
+            The generator used for shuffling; equal seeds replay the same fill.
         *******************************************************************************/
-        GetMapStochasticAdjacents(int* map, int size)
-            : GetMapAdjacents{ map, size }
+        GetMapStochasticAdjacents(int* map, int size, Random rng = Random{})
+            : GetMapAdjacents{ map, size }, rng{ rng }
         {
         }
 
@@ -126,6 +131,7 @@ namespace AI
     struct Queue : Interface
     {
         std::list<Node*> p_Node;
+        std::size_t peak = 0; // largest size reached since the last clear()
 
         void clear();
 
@@ -143,6 +149,7 @@ namespace AI
     {
 
         std::list<Node*> p_Node;
+        std::size_t peak = 0; // largest size reached since the last clear()
 
         void clear();
 
@@ -185,6 +192,67 @@ namespace AI
         void run(Key key, int color);
     };
 
+    /*!*****************************************************************************
+     * \brief
+        Class for performing the recursive flood fill without recursion.
+        Every call of Flood_Fill_Recursive::run becomes a frame on a heap
+        allocated stack, so cells are visited in exactly the same order but
+        the depth of the fill is no longer limited by the thread stack.
+    *******************************************************************************/
+    class Flood_Fill_Explicit_Stack
+    {
+        // Suspended call: adjacent nodes of a cell and the next one to visit
+        struct Frame
+        {
+            std::vector<Node*> adjacents;
+            std::size_t next;
+        };
+
+        GetAdjacents* pGetAdjacents;
+        std::vector<Frame> frames; // kept between runs so frames are reused
+        std::size_t peak;
+
+    public:
+        /*!*****************************************************************************
+         * \brief
+            Constructs a `Flood_Fill_Explicit_Stack` object.
+         *
+         * \param pGetAdjacents
+            Pointer to a GetAdjacents object used for retrieving adjacent nodes.
+
+         * \param capacity
+            Number of frames to preallocate.
+        *******************************************************************************/
+        Flood_Fill_Explicit_Stack(GetAdjacents* pGetAdjacents, std::size_t capacity = 1024)
+            : pGetAdjacents{ pGetAdjacents }, frames(capacity), peak{ 0 }
+        {
+        }
+
+        /*!*****************************************************************************
+         * \brief
+            Runs the flood fill algorithm with an explicit stack.
+         *
+         * \param key
+            The key of the starting node for flood fill.
+
+         * \param color
+            The color to fill the connected nodes with.
+        *******************************************************************************/
+        void run(Key key, int color);
+
+        /*!*****************************************************************************
+         * \brief
+            Returns the deepest the stack of frames got during the last run.
+        *******************************************************************************/
+        std::size_t getPeak() const { return peak; }
+
+        /*!*****************************************************************************
+         * \brief
+            Returns the number of frames kept for the next run.
+        *******************************************************************************/
+        std::size_t getFrames() const { return frames.size(); }
+    };
+
     /*!*****************************************************************************
      * \brief 
         Class for performing iterative flood fill.
@@ -221,6 +289,12 @@ namespace AI
             The color to fill the connected nodes with.
         *******************************************************************************/
         void run(Key key, int color);
+
+        /*!*****************************************************************************
+         * \brief
+            Returns the largest size the open list reached during the last run.
+        *******************************************************************************/
+        std::size_t getPeak() const { return openlist.peak; }
     };
 
 } // end namespace
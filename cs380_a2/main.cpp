@@ -15,10 +15,14 @@ void test7();
 void test8();
 void test9();
 void test10();
+void test11();
+void test12();
+void test13();
+void test14();
 
 int main(int argc, char* argv[])
 {
-    void (*f[])() = { test1, test2, test3, test4, test5, test6, test7, test8, test9, test10 };
+    void (*f[])() = { test1, test2, test3, test4, test5, test6, test7, test8, test9, test10, test11, test12, test13, test14 };
     const int SIZE = sizeof(f) / sizeof(f[0]);
     int id = -1;
 
@@ -377,3 +381,158 @@ void test10()
     else
         std::cout << "Failed (" << std::endl << join(actual, 25) << ')' << std::endl;
 }
+
+void test11()
+{
+    int actual[] = {
+        0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0,
+        0, 0, 0, 0, 1,
+        0, 0, 0, 1, 0,
+        0, 0, 1, 0, 0
+    };
+
+    AI::GetMapAdjacents getAdjacents{ actual, 5 };
+
+    AI::Flood_Fill_Explicit_Stack(&getAdjacents).run(AI::Key{ 0, 0 }, 2);
+
+    int expected[] = {
+        2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2,
+        2, 2, 2, 2, 1,
+        2, 2, 2, 1, 0,
+        2, 2, 1, 0, 0
+    };
+
+    std::cout << "Test 11 : ";
+    if (std::equal(actual, actual + 25, expected))
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << join(actual, 25) << ')' << std::endl;
+}
+
+// Open map whose fill is far deeper than a thread stack allows recursively
+void test12()
+{
+    const int size = 512;
+    std::vector<int> actual(size * size, 0);
+
+    AI::GetMapAdjacents getAdjacents{ actual.data(), size };
+
+    AI::Flood_Fill_Explicit_Stack fill(&getAdjacents);
+    fill.run(AI::Key{ 0, 0 }, 2);
+
+    // The stack outgrew the preallocated frames and kept every one it made
+    std::size_t peak = fill.getPeak();
+    bool deep = peak > 1024 && peak <= static_cast<std::size_t>(size * size) && fill.getFrames() == peak;
+
+    fill.run(AI::Key{ 0, 0 }, 3); // Nothing left to fill, frames are reused
+    bool reused = fill.getPeak() == 1 && fill.getFrames() == peak;
+
+    bool filled = std::all_of(actual.begin(), actual.end(), [](int v) { return v == 2; });
+
+    std::cout << "Test 12 : ";
+    if (filled && deep && reused)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << peak << ')' << std::endl;
+}
+
+// Equal seeds replay the same shuffles, other streams shuffle differently
+void test13()
+{
+    int map[] = {
+        0, 0, 0,
+        0, 0, 0,
+        0, 0, 0
+    };
+
+    AI::GetMapStochasticAdjacents a{ map, 3, AI::Random{ 7 } };
+    AI::GetMapStochasticAdjacents b{ map, 3, AI::Random{ 7 } };
+    AI::GetMapStochasticAdjacents c{ map, 3, AI::Random{ 7, 1 } };
+
+    std::string actualA, actualB, actualC;
+    int orders[24] = {};
+    for (int n = 0; n < 240; ++n)
+    {
+        std::ostringstream osA, osB, osC;
+        std::vector<AI::Node*> adjA = a(AI::Key{ 1, 1 });
+        std::vector<AI::Node*> adjB = b(AI::Key{ 1, 1 });
+        std::vector<AI::Node*> adjC = c(AI::Key{ 1, 1 });
+        osA << adjA;
+        osB << adjB;
+        osC << adjC;
+        actualA += osA.str() + ' ';
+        actualB += osB.str() + ' ';
+        actualC += osC.str() + ' ';
+
+        // Rank of the permutation, to check that every order shows up
+        int rank = 0;
+        for (int k = 0; k < 4; ++k)
+        {
+            int smaller = 0;
+            for (int m = k + 1; m < 4; ++m)
+                smaller += (adjA[m]->pValue < adjA[k]->pValue);
+            rank = rank * (4 - k) + smaller;
+        }
+        ++orders[rank];
+
+        for (auto adj : adjA) delete adj;
+        for (auto adj : adjB) delete adj;
+        for (auto adj : adjC) delete adj;
+    }
+
+    std::cout << "Test 13 : ";
+    if (actualA == actualB && actualA != actualC
+        && std::find(orders, orders + 24, 0) == orders + 24)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actualA << ')' << std::endl;
+}
+
+// Records the cells whose adjacent nodes are asked for, in order
+class GetRecordedAdjacents : public AI::GetAdjacents
+{
+    AI::GetAdjacents* pGetAdjacents;
+
+public:
+    std::vector<AI::Key> visits;
+
+    GetRecordedAdjacents(AI::GetAdjacents* pGetAdjacents)
+        : AI::GetAdjacents(), pGetAdjacents{ pGetAdjacents }, visits{}
+    {
+    }
+
+    std::vector<AI::Node*> operator()(AI::Key key)
+    {
+        visits.push_back(key);
+        return pGetAdjacents->operator()(key);
+    }
+};
+
+// The explicit stack visits cells in the same order as the recursion
+void test14()
+{
+    const int size = 24;
+    std::vector<int> recursive(size * size, 0);
+    for (int j = 0; j < size; ++j)
+        for (int i = 0; i < size; ++i)
+            if ((j * 7 + i * 13) % 5 == 0 && (j + i) % 3 != 0)
+                recursive[j * size + i] = 1;
+    std::vector<int> explicitStack = recursive;
+
+    // Equal seeds shuffle both fills the same way, so every order is compared
+    AI::GetMapStochasticAdjacents shuffledA{ recursive.data(), size, AI::Random{ 11 } };
+    AI::GetMapStochasticAdjacents shuffledB{ explicitStack.data(), size, AI::Random{ 11 } };
+    GetRecordedAdjacents a{ &shuffledA };
+    GetRecordedAdjacents b{ &shuffledB };
+
+    AI::Flood_Fill_Recursive(&a).run(AI::Key{ 0, 0 }, 2);
+    AI::Flood_Fill_Explicit_Stack(&b, 4).run(AI::Key{ 0, 0 }, 2);
+
+    std::cout << "Test 14 : ";
+    if (a.visits.size() > size * size / 2 && a.visits == b.visits && recursive == explicitStack)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << a.visits.size() << ' ' << b.visits.size() << ')' << std::endl;
+}
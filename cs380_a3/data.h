@@ -1,9 +1,55 @@
 #ifndef DATA_H
 #define DATA_H
 
+#include <cstdint>
+
 namespace AI 
 {
 
+    // Small and fast pseudo random number generator (PCG32). A generator is
+    // one independent stream: seed it explicitly to replay a sequence, and
+    // give every thread its own stream instead of sharing the global rand().
+    class Random
+    {
+        std::uint64_t state;
+        std::uint64_t inc; // odd increment that selects the stream
+
+    public:
+
+        using result_type = std::uint32_t;
+
+        Random(std::uint64_t seed = 0x853c49e6748fea9bULL, std::uint64_t stream = 0)
+            : state{ 0 }, inc{ (stream << 1u) | 1u }
+        {
+            operator()();
+            state += seed;
+            operator()();
+        }
+
+        // Generator on another stream, seeded from the current state
+        Random fork(std::uint64_t stream) const
+        {
+            return Random{ state, stream };
+        }
+
+        result_type operator()()
+        {
+            std::uint64_t old = state;
+            state = old * 6364136223846793005ULL + inc;
+            std::uint32_t xorshifted = static_cast<std::uint32_t>(((old >> 18u) ^ old) >> 27u);
+            std::uint32_t rot = static_cast<std::uint32_t>(old >> 59u);
+            return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+        }
+
+        // Number in [0, bound) by multiply and shift, without division or loops
+        std::uint32_t below(std::uint32_t bound)
+        {
+            return static_cast<std::uint32_t>((static_cast<std::uint64_t>(operator()()) * bound) >> 32u);
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return 0xffffffffu; }
+    };
 
 }
 
@@ -17,6 +17,11 @@ Technology is prohibited.
 *******************************************************************************/
 #include "functions.h"
 
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+
 namespace AI 
 {
 
@@ -85,6 +90,42 @@ namespace AI
         return list;
     }
 
+    /*!*****************************************************************************
+    \brief
+        Passes the children of pNode with value "x" to the callback without
+        allocating.
+
+    \param pNode
+        The TreeNode for which adjacent nodes are to be visited.
+
+    \param callback
+        The callback invoked once for each adjacent node.
+    *******************************************************************************/
+    void GetTreeAdjacents::forEach(TreeNode* pNode, AdjacentCallback& callback)
+    {
+        for (auto node : pNode->children) {
+
+            if (node->value == "x")
+                callback(node);
+        }
+    }
+
+    /*!*****************************************************************************
+    \brief
+        Returns a new functor of the same kind for use on another thread.
+
+    \param stream
+        Stream of random numbers for functors that shuffle.
+
+    \return
+        A functor owned by the caller.
+    *******************************************************************************/
+    GetTreeAdjacents* GetTreeAdjacents::clone(std::uint64_t stream) const
+    {
+        UNUSED(stream)
+        return new GetTreeAdjacents{};
+    }
+
     /*!*****************************************************************************
      * \brief
         Returns a vector of shuffled adjacent nodes in a map.
@@ -101,11 +142,70 @@ namespace AI
             adjacents = GetTreeAdjacents::operator()(pNode);
 
             // Use the base class operator() and then shuffle the result
-            std::random_shuffle(adjacents.begin(), adjacents.end());
+            shuffle(adjacents);
 
             return adjacents;
     }
 
+    /*!*****************************************************************************
+     * \brief
+        Passes the adjacent nodes in shuffled order to the callback. Buffers
+        are reused, so no allocation happens once they are warmed up.
+     *
+     * \param pNode
+        The TreeNode for which adjacent nodes are to be visited.
+     *
+     * \param callback
+        The callback invoked once for each adjacent node.
+    *******************************************************************************/
+    void GetTreeStochasticAdjacents::forEach(TreeNode* pNode, AdjacentCallback& callback)
+    {
+        if (depth == buffers.size())
+            buffers.emplace_back();
+        std::vector<TreeNode*>& adjacents = buffers[depth++];
+
+        adjacents.clear();
+        for (auto node : pNode->children) {
+
+            if (node->value == "x")
+                adjacents.emplace_back(node);
+        }
+        shuffle(adjacents);
+
+        for (TreeNode* adj : adjacents)
+            callback(adj);
+        --depth;
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Returns a stochastic functor that shuffles with its own stream forked
+        from this one.
+     *
+     * \param stream
+        Stream of random numbers of the new functor.
+     *
+     * \return
+        A functor owned by the caller.
+    *******************************************************************************/
+    GetTreeAdjacents* GetTreeStochasticAdjacents::clone(std::uint64_t stream) const
+    {
+        return new GetTreeStochasticAdjacents{ rng.fork(stream) };
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Fisher-Yates shuffle drawing from the functor's own generator.
+     *
+     * \param adjacents
+        The nodes to shuffle in place.
+    *******************************************************************************/
+    void GetTreeStochasticAdjacents::shuffle(std::vector<TreeNode*>& adjacents)
+    {
+        for (std::size_t k = adjacents.size(); k > 1; --k)
+            std::swap(adjacents[k - 1], adjacents[rng.below(static_cast<std::uint32_t>(k))]);
+    }
+
     /*!*****************************************************************************
      * \brief
         Runs the flood fill algorithm recursively.
@@ -119,16 +219,347 @@ namespace AI
     void Flood_Fill_Recursive::run(TreeNode* pNode, std::string value)
     {
         // Implement the flood fill
-        std::vector<TreeNode*> adjacents = pGetAdjacents->operator()(pNode);
+        fill(pNode, value);
+    }
 
-        for (TreeNode* adj : adjacents)
+    /*!*****************************************************************************
+     * \brief
+        Fills the adjacent nodes of pNode and recurses into them.
+     *
+     * \param pNode
+        The node whose adjacent nodes are filled.
+
+     * \param value
+        The value to fill the connected nodes with.
+    *******************************************************************************/
+    void Flood_Fill_Recursive::fill(TreeNode* pNode, const std::string& value)
+    {
+        struct Recurse : AdjacentCallback
         {
+            Flood_Fill_Recursive* self;
+            const std::string* value;
+
+            void operator()(TreeNode* adj)
+            {
+                adj->value = *value;
+                self->fill(adj, *value);
+            }
+        } recurse;
+
+        recurse.self = this;
+        recurse.value = &value;
+        pGetAdjacents->forEach(pNode, recurse);
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Runs the flood fill algorithm with an explicit stack.
+     *
+     * \param pNode
+        The pNode of the starting node for flood fill.
+
+     * \param value
+        The value to fill the connected nodes with.
+    *******************************************************************************/
+    void Flood_Fill_Explicit_Stack::run(TreeNode* pNode, std::string value)
+    {
+        // Collects adjacent nodes into a frame, reusing its capacity
+        struct Collect : AdjacentCallback
+        {
+            std::vector<TreeNode*>* adjacents;
+
+            void operator()(TreeNode* adj)
+            {
+                adjacents->emplace_back(adj);
+            }
+        } collect;
+
+        std::size_t top = 0;
+
+        // Same as entering Flood_Fill_Recursive::run(node, value)
+        auto call = [&](TreeNode* node)
+        {
+            if (top == frames.size())
+                frames.emplace_back();
+            frames[top].adjacents.clear();
+            frames[top].next = 0;
+            collect.adjacents = &frames[top].adjacents;
+            pGetAdjacents->forEach(node, collect);
+            ++top;
+        };
+
+        call(pNode);
+
+        while (top)
+        {
+            Frame& frame = frames[top - 1];
+            if (frame.next == frame.adjacents.size())
+            {
+                --top; // return from the call
+                continue;
+            }
+
+            TreeNode* adj = frame.adjacents[frame.next++];
             adj->value = value;
-            run(adj, value);
-            //delete adj;
+            call(adj); // may grow frames, so frame is not used after this
+        }
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Constructs a `Flood_Fill_Parallel` object.
+     *
+     * \param pGetAdjacents
+        Pointer to a GetAdjacents object used for retrieving adjacent nodes.
+
+     * \param threads
+        Number of worker threads, 0 uses one per hardware thread.
+
+     * \param cutoff
+        Number of nodes a task fills sequentially before sharing its work.
+    *******************************************************************************/
+    Flood_Fill_Parallel::Flood_Fill_Parallel(GetTreeAdjacents* pGetAdjacents,
+        unsigned threads, std::size_t cutoff)
+        : pGetAdjacents{ pGetAdjacents }
+        , threads{ threads ? threads : std::max(1u, std::thread::hardware_concurrency()) }
+        , cutoff{ std::max<std::size_t>(1, cutoff) }
+    {
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Runs the parallel flood fill algorithm.
+     *
+     * \param pNode
+        The TreeNode of the starting node for flood fill.
+
+     * \param value
+        The string to fill the connected nodes with.
+    *******************************************************************************/
+    void Flood_Fill_Parallel::run(TreeNode* pNode, std::string value)
+    {
+        // Every worker owns a deque of subtree roots. The owner takes from the
+        // back (most recent, best locality), thieves take from the front
+        // (oldest, closest to the root and so the largest subtrees).
+        struct Worker
+        {
+            std::mutex lock;
+            std::deque<TreeNode*> tasks;
+        };
+
+        std::vector<Worker> workers(threads);
+        std::atomic<std::size_t> pending{ 1 }; // tasks queued or running
+        workers[0].tasks.push_back(pNode);
+
+        auto take = [&](unsigned self) -> TreeNode*
+        {
+            for (unsigned k = 0; k < threads; ++k)
+            {
+                unsigned victim = (self + k) % threads;
+                std::lock_guard<std::mutex> guard{ workers[victim].lock };
+                std::deque<TreeNode*>& tasks = workers[victim].tasks;
+                if (tasks.empty())
+                    continue;
+
+                TreeNode* task = nullptr;
+                if (victim == self)
+                {
+                    task = tasks.back();
+                    tasks.pop_back();
+                }
+                else
+                {
+                    task = tasks.front();
+                    tasks.pop_front();
+                }
+                return task;
+            }
+            return nullptr;
+        };
+
+        auto work = [&](unsigned self)
+        {
+            std::unique_ptr<GetTreeAdjacents> getAdjacents{ pGetAdjacents->clone(self) };
+
+            struct Push : AdjacentCallback
+            {
+                std::vector<TreeNode*>* stack;
+                const std::string* value;
+
+                void operator()(TreeNode* adj)
+                {
+                    adj->value = *value;
+                    stack->push_back(adj);
+                }
+            } push;
+
+            std::vector<TreeNode*> stack;
+            push.stack = &stack;
+            push.value = &value;
+
+            while (pending.load(std::memory_order_acquire))
+            {
+                TreeNode* task = take(self);
+                if (!task)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                // Fill the subtree sequentially until it proves to be large
+                std::size_t filled = 0;
+                stack.push_back(task);
+                while (!stack.empty())
+                {
+                    TreeNode* current = stack.back();
+                    stack.pop_back();
+                    getAdjacents->forEach(current, push);
+
+                    if (++filled >= cutoff && stack.size() > 1)
+                    {
+                        // Share all but the newest subtree root
+                        std::size_t shared = stack.size() - 1;
+                        pending.fetch_add(shared, std::memory_order_relaxed);
+                        {
+                            std::lock_guard<std::mutex> guard{ workers[self].lock };
+                            workers[self].tasks.insert(workers[self].tasks.end(),
+                                stack.begin(), stack.begin() + shared);
+                        }
+                        stack.erase(stack.begin(), stack.begin() + shared);
+                        filled = 0;
+                    }
+                }
+
+                pending.fetch_sub(1, std::memory_order_release);
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned k = 1; k < threads; ++k)
+            pool.emplace_back(work, k);
+        work(0);
+
+        for (std::thread& thread : pool)
+            thread.join();
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Flattens the tree rooted at pNode.
+     *
+     * \param pNode
+        Root of the tree to flatten.
+    *******************************************************************************/
+    PreorderTree::PreorderTree(TreeNode* pNode)
+    {
+        // Preorder walk with an explicit stack. The end of a subtree is known
+        // once all children of its root have been walked.
+        struct Visit
+        {
+            std::size_t entry;                     // preorder index of the node
+            std::list<TreeNode*>::iterator next;   // next child to walk
+            std::list<TreeNode*>::iterator last;
+        };
+        std::vector<Visit> stack;
+
+        auto enter = [&](TreeNode* node)
+        {
+            stack.push_back({ nodes.size(), node->children.begin(), node->children.end() });
+            nodes.push_back(node);
+            codes.push_back(code(node->value));
+            ends.push_back(0);
+        };
+
+        enter(pNode);
+
+        while (!stack.empty())
+        {
+            Visit& visit = stack.back();
+            if (visit.next == visit.last)
+            {
+                ends[visit.entry] = nodes.size();
+                stack.pop_back();
+                continue;
+            }
+
+            TreeNode* child = *visit.next++;
+            enter(child); // may grow stack, so visit is not used after this
         }
     }
 
+    /*!*****************************************************************************
+     * \brief
+        Replaces the "x" nodes connected to a node, like the other fills do.
+     *
+     * \param index
+        Preorder index of the starting node, 0 is the root.
+
+     * \param value
+        The string to fill the connected nodes with.
+     *
+     * \return
+        Number of filled nodes.
+    *******************************************************************************/
+    std::size_t PreorderTree::fill(std::size_t index, const std::string& value)
+    {
+        if (index >= codes.size())
+            return 0;
+
+        auto x = lookup.find("x");
+        if (x == lookup.end())
+            return 0;
+
+        const int from = x->second;
+        const int to = code(value);
+        const std::size_t end = ends[index];
+        std::size_t filled = 0;
+
+        // Children of a filled node follow it directly, any other node is
+        // skipped together with its subtree
+        for (std::size_t k = index + 1; k < end; )
+        {
+            const bool hit = codes[k] == from;
+            codes[k] = hit ? to : codes[k];
+            filled += hit;
+            k = hit ? k + 1 : ends[k];
+        }
+
+        return filled;
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Writes the values back into the nodes of the original tree.
+    *******************************************************************************/
+    void PreorderTree::store() const
+    {
+        for (std::size_t k = 0; k < nodes.size(); ++k)
+            if (nodes[k]->value != values[codes[k]])
+                nodes[k]->value = values[codes[k]];
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Returns the code of a value, adding it to the dictionary if needed.
+     *
+     * \param value
+        The value to look up.
+     *
+     * \return
+        The code of the value.
+    *******************************************************************************/
+    int PreorderTree::code(const std::string& value)
+    {
+        auto it = lookup.find(value);
+        if (it != lookup.end())
+            return it->second;
+
+        int next = static_cast<int>(values.size());
+        values.push_back(value);
+        lookup.emplace(value, next);
+        return next;
+    }
+
     /*!*****************************************************************************
      * \brief
         Runs the iterative flood fill algorithm.
@@ -142,6 +573,22 @@ namespace AI
     template<typename T>
     inline void Flood_Fill_Iterative<T>::run(TreeNode* pNode, std::string value)
     {
+        // Fills an adjacent node and queues it for expansion
+        struct Push : AdjacentCallback
+        {
+            T* openlist;
+            const std::string* value;
+
+            void operator()(TreeNode* adj)
+            {
+                adj->value = *value;
+                openlist->push(adj);
+            }
+        } push;
+
+        push.openlist = &openlist;
+        push.value = &value;
+
         // Implement the flood fill
         openlist.clear();
         openlist.push(pNode);
@@ -149,13 +596,7 @@ namespace AI
         while (!openlist.isEmpty())
         {
             TreeNode* current = openlist.pop();
-            std::vector<TreeNode*> adjacents = pGetAdjacents->operator()(current);
-
-            for (TreeNode* adj : adjacents)
-            {
-                adj->value = value;
-                openlist.push(adj);
-            }
+            pGetAdjacents->forEach(current, push);
             //delete current;
         }
     }
@@ -24,8 +24,10 @@ Technology is prohibited.
 #include <iostream>
 #include <vector>
 #include <list>
+#include <deque>
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <algorithm>
 
 #include "data.h"
@@ -223,6 +225,21 @@ namespace AI
     using TreeNode = Node<std::string>;
 
 
+    // Abstract base class for callbacks that receive adjacent nodes one by one,
+    // so fills do not have to build a vector for every visited node
+    class AdjacentCallback
+    {
+
+    public:
+
+        virtual ~AdjacentCallback()
+        {
+        }
+
+        virtual void operator()(TreeNode* pNode) = 0;
+    };
+
+
     // Abstract base class for domain specific functors that return adjacent nodes
     class GetAdjacents
     {
@@ -234,6 +251,24 @@ namespace AI
         }
 
         virtual std::vector<TreeNode*> operator()(TreeNode* pNode) = 0;
+
+        /*!*****************************************************************************
+         * \brief
+            Passes every adjacent node of pNode to the callback in the same order
+            as operator() returns them. Domain functors override it to skip the
+            temporary vector.
+         *
+         * \param pNode
+            The TreeNode for which adjacent nodes are to be visited.
+         *
+         * \param callback
+            The callback invoked once for each adjacent node.
+        *******************************************************************************/
+        virtual void forEach(TreeNode* pNode, AdjacentCallback& callback)
+        {
+            for (TreeNode* adj : operator()(pNode))
+                callback(adj);
+        }
     };
 
 
@@ -262,18 +297,52 @@ namespace AI
             A vector of pointers to AI::Node objects representing the adjacent nodes.
         *******************************************************************************/
         std::vector<TreeNode*> operator()(TreeNode* pNode);
+
+        /*!*****************************************************************************
+         * \brief
+            Passes the children of pNode with value "x" to the callback without
+            allocating.
+         *
+         * \param pNode
+            The TreeNode for which adjacent nodes are to be visited.
+         *
+         * \param callback
+            The callback invoked once for each adjacent node.
+        *******************************************************************************/
+        void forEach(TreeNode* pNode, AdjacentCallback& callback);
+
+        /*!*****************************************************************************
+         * \brief
+            Returns a new functor of the same kind for use on another thread.
+         *
+         * \param stream
+            Stream of random numbers for functors that shuffle.
+         *
+         * \return
+            A functor owned by the caller.
+        *******************************************************************************/
+        virtual GetTreeAdjacents* clone(std::uint64_t stream) const;
     };
 
     // Domain specific functor that returns shuffled adjacent nodes
     class GetTreeStochasticAdjacents : public GetTreeAdjacents
     {
+        // One shuffle buffer per nesting level of forEach, so a callback may
+        // recurse into the functor; deque keeps outer buffers in place
+        std::deque<std::vector<TreeNode*>> buffers;
+        std::size_t depth;
+        Random rng; // own stream, so functors on other threads do not interfere
+
     public:
         /*!*****************************************************************************
         \brief
-        Default Constructor
+        Constructor
+
+        \param rng
+        The generator used for shuffling; equal seeds replay the same fill.
         *******************************************************************************/
-        GetTreeStochasticAdjacents()
-            : GetTreeAdjacents{}
+        GetTreeStochasticAdjacents(Random rng = Random{})
+            : GetTreeAdjacents{}, buffers{}, depth{ 0 }, rng{ rng }
         {
         }
 
@@ -288,14 +357,50 @@ namespace AI
             A vector of pointers to shuffled adjacent nodes in the map.
         *******************************************************************************/
         std::vector<TreeNode*> operator()(TreeNode* pNode);
+
+        /*!*****************************************************************************
+         * \brief
+            Passes the adjacent nodes in shuffled order to the callback. Buffers
+            are reused, so no allocation happens once they are warmed up.
+         *
+         * \param pNode
+            The TreeNode for which adjacent nodes are to be visited.
+         *
+         * \param callback
+            The callback invoked once for each adjacent node.
+        *******************************************************************************/
+        void forEach(TreeNode* pNode, AdjacentCallback& callback);
+
+        /*!*****************************************************************************
+         * \brief
+            Returns a stochastic functor that shuffles with its own stream forked
+            from this one.
+         *
+         * \param stream
+            Stream of random numbers of the new functor.
+         *
+         * \return
+            A functor owned by the caller.
+        *******************************************************************************/
+        GetTreeAdjacents* clone(std::uint64_t stream) const;
+
+    private:
+        /*!*****************************************************************************
+         * \brief
+            Fisher-Yates shuffle drawing from the functor's own generator.
+        *******************************************************************************/
+        void shuffle(std::vector<TreeNode*>& adjacents);
     };
 
     /*!*****************************************************************************
     // Wrappers that provide same interface for queue and stack
+    // Storage is a vector that keeps its capacity, so pushes stop allocating
+    // once the open list has reached its largest size
     *******************************************************************************/
     struct Interface
     {
-        std::list<TreeNode*> p_Node;
+        std::vector<TreeNode*> p_Node;
+        std::size_t head = 0; // index of the front element
 
         virtual void clear() = 0;
 
@@ -303,7 +408,7 @@ namespace AI
 
         virtual TreeNode* pop() = 0;
 
-        bool isEmpty() { return p_Node.size() == 0; }
+        bool isEmpty() { return head == p_Node.size(); }
     };
 
     /*!*****************************************************************************
@@ -314,21 +419,35 @@ namespace AI
         void clear()
         {
             p_Node.clear();
+            head = 0;
         }
 
         void push(TreeNode* pNode)
         {
+            if (isEmpty())
+                clear(); // reuse the space of popped elements
             p_Node.emplace_back(pNode);
         }
 
         TreeNode* pop()
         {
             TreeNode* pNode = nullptr;
-            pNode = p_Node.front();
-            p_Node.pop_front();
+            pNode = p_Node[head++];
+
+            // Once most of the vector is popped, move the rest to the front so
+            // the memory follows the frontier rather than every node pushed.
+            // Fewer elements are moved than were popped, so pops stay O(1).
+            if (head >= COMPACT && head * 2 > p_Node.size())
+            {
+                p_Node.erase(p_Node.begin(), p_Node.begin() + head);
+                head = 0;
+            }
 
             return pNode;
         }
+
+    private:
+        static constexpr std::size_t COMPACT = 64; // fewest popped elements worth moving
     };
 
     /*!*****************************************************************************
@@ -339,6 +458,7 @@ namespace AI
         void clear()
         {
             p_Node.clear();
+            head = 0;
         }
 
         void push(TreeNode* pNode)
@@ -387,6 +507,166 @@ namespace AI
             The value to fill the connected nodes with.
         *******************************************************************************/
         void run(TreeNode* pNode, std::string value);
+
+    private:
+        /*!*****************************************************************************
+         * \brief
+            Fills the adjacent nodes of pNode and recurses into them.
+        *******************************************************************************/
+        void fill(TreeNode* pNode, const std::string& value);
+    };
+
+    /*!*****************************************************************************
+     * \brief
+        Class for performing the recursive flood fill without recursion.
+        Every call of Flood_Fill_Recursive::run becomes a frame on a heap
+        allocated stack, so nodes are visited in exactly the same order but
+        the depth of the tree is no longer limited by the thread stack.
+    *******************************************************************************/
+    class Flood_Fill_Explicit_Stack
+    {
+        // Suspended call: adjacent nodes of a node and the next one to visit
+        struct Frame
+        {
+            std::vector<TreeNode*> adjacents;
+            std::size_t next;
+        };
+
+        GetTreeAdjacents* pGetAdjacents;
+        std::vector<Frame> frames; // kept between runs so frames are reused
+
+    public:
+        /*!*****************************************************************************
+         * \brief
+            Constructs a `Flood_Fill_Explicit_Stack` object.
+         *
+         * \param pGetAdjacents
+            Pointer to a GetAdjacents object used for retrieving adjacent nodes.
+
+         * \param capacity
+            Number of frames to preallocate.
+        *******************************************************************************/
+        Flood_Fill_Explicit_Stack(GetTreeAdjacents* pGetAdjacents, std::size_t capacity = 1024)
+            : pGetAdjacents{ pGetAdjacents }, frames(capacity)
+        {
+        }
+
+        /*!*****************************************************************************
+         * \brief
+            Runs the flood fill algorithm with an explicit stack.
+         *
+         * \param pNode
+            The pNode of the starting node for flood fill.
+
+         * \param value
+            The value to fill the connected nodes with.
+        *******************************************************************************/
+        void run(TreeNode* pNode, std::string value);
+    };
+
+    /*!*****************************************************************************
+     * \brief
+        Class for performing flood fill on several threads. Subtrees of filled
+        nodes are independent, so they become tasks on a work-stealing
+        scheduler. A task fills its subtree depth-first and only shares the
+        rest of its work once it has filled `cutoff` nodes, so small subtrees
+        never pay for scheduling. Every worker visits through its own clone of the adjacency functor.
+    *******************************************************************************/
+    class Flood_Fill_Parallel
+    {
+        GetTreeAdjacents* pGetAdjacents;
+        unsigned threads;
+        std::size_t cutoff;
+
+    public:
+        /*!*****************************************************************************
+         * \brief
+            Constructs a `Flood_Fill_Parallel` object.
+         *
+         * \param pGetAdjacents
+            Pointer to a GetAdjacents object used for retrieving adjacent nodes.
+
+         * \param threads
+            Number of worker threads, 0 uses one per hardware thread.
+
+         * \param cutoff
+            Number of nodes a task fills sequentially before sharing its work.
+        *******************************************************************************/
+        Flood_Fill_Parallel(GetTreeAdjacents* pGetAdjacents, unsigned threads = 0,
+            std::size_t cutoff = 1024);
+
+        /*!*****************************************************************************
+         * \brief
+            Runs the parallel flood fill algorithm.
+         *
+         * \param pNode
+            The TreeNode of the starting node for flood fill.
+
+         * \param value
+            The string to fill the connected nodes with.
+        *******************************************************************************/
+        void run(TreeNode* pNode, std::string value);
+    };
+
+    /*!*****************************************************************************
+     * \brief
+        Tree flattened into preorder arrays for fast fills. Values are interned
+        into integer codes and every node stores the index one past the end of
+        its subtree, so the subtree of node k is the range [k, ends[k]). A fill
+        becomes one linear scan that steps into "x" nodes and jumps over the
+        subtrees of all other nodes.
+    *******************************************************************************/
+    class PreorderTree
+    {
+        std::vector<int> codes;            // value code of each node in preorder
+        std::vector<std::size_t> ends;     // one past the last node of each subtree
+        std::vector<TreeNode*> nodes;      // original node of each entry
+        std::vector<std::string> values;   // value of each code
+        std::unordered_map<std::string, int> lookup; // code of each value
+
+    public:
+        /*!*****************************************************************************
+         * \brief
+            Flattens the tree rooted at pNode.
+         *
+         * \param pNode
+            Root of the tree to flatten.
+        *******************************************************************************/
+        PreorderTree(TreeNode* pNode);
+
+        /*!*****************************************************************************
+         * \brief
+            Replaces the "x" nodes connected to a node, like the other fills do.
+         *
+         * \param index
+            Preorder index of the starting node, 0 is the root.
+
+         * \param value
+            The string to fill the connected nodes with.
+         *
+         * \return
+            Number of filled nodes.
+        *******************************************************************************/
+        std::size_t fill(std::size_t index, const std::string& value);
+
+        /*!*****************************************************************************
+         * \brief
+            Writes the values back into the nodes of the original tree.
+        *******************************************************************************/
+        void store() const;
+
+        /*!*****************************************************************************
+         * \brief
+            Returns the number of nodes in the tree.
+        *******************************************************************************/
+        std::size_t size() const { return codes.size(); }
+
+    private:
+        /*!*****************************************************************************
+         * \brief
+            Returns the code of a value, adding it to the dictionary if needed.
+        *******************************************************************************/
+        int code(const std::string& value);
     };
 
     // Iterative Flood Fill
@@ -15,10 +15,17 @@ void test7();
 void test8();
 void test9();
 void test10();
+void test11();
+void test12();
+void test13();
+void test14();
+void test15();
+void test16();
+void test17();
 
 int main(int argc, char* argv[])
 {
-    void (*f[])() = { test1, test2, test3, test4, test5, test6, test7, test8, test9, test10 };
+    void (*f[])() = { test1, test2, test3, test4, test5, test6, test7, test8, test9, test10, test11, test12, test13, test14, test15, test16, test17 };
     const int SIZE = sizeof(f) / sizeof(f[0]);
     int id = -1;
 
@@ -367,3 +374,231 @@ a {3\
     else
         std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
 }
+
+void test11()
+{
+    std::istringstream istream{"\
+a {3\
+ aa {0 }\
+ x {2 aba {0 } x {0 } }\
+ ac {0 } } "};
+
+    AI::TreeNode tree;
+
+    istream >> tree;
+
+    AI::GetTreeAdjacents getAdjacents;
+
+    AI::Flood_Fill_Explicit_Stack(&getAdjacents).run(&tree, "z");
+
+    std::ostringstream os;
+    os << tree;
+
+    std::string actual = os.str();
+    std::string expected = "a {3 aa {0 } z {2 aba {0 } z {0 } } ac {0 } } ";
+
+    std::cout << "Test 11 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Long chain of x-s that is deeper than the frames preallocated by the fill
+void test12()
+{
+    const int depth = 20000;
+
+    AI::TreeNode tree{ "a" };
+    AI::TreeNode* node = &tree;
+    for (int i = 0; i < depth; ++i)
+    {
+        node->children.push_back(new AI::TreeNode{ "x", node });
+        node = node->children.back();
+    }
+
+    AI::GetTreeAdjacents getAdjacents;
+
+    AI::Flood_Fill_Explicit_Stack(&getAdjacents, 16).run(&tree, "z");
+
+    int filled = 0;
+    for (node = &tree; !node->children.empty(); node = node->children.front())
+        filled += (node->children.front()->value == "z");
+
+    std::cout << "Test 12 : ";
+    if (filled == depth)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << filled << ')' << std::endl;
+}
+
+// Visiting adjacent nodes through a callback yields the same nodes as operator()
+void test13()
+{
+    std::istringstream istream{"\
+a {4\
+ x {0 }\
+ ab {1 x {0 } }\
+ x {2 aca {0 } acc {0 } }\
+ ad {0 } } "};
+
+    AI::TreeNode tree;
+
+    istream >> tree;
+
+    struct Collect : AI::AdjacentCallback
+    {
+        std::vector<AI::TreeNode*> adjacents;
+
+        void operator()(AI::TreeNode* pNode)
+        {
+            adjacents.push_back(pNode);
+        }
+    } collect;
+
+    AI::GetTreeAdjacents getAdjacents;
+    getAdjacents.forEach(&tree, collect);
+
+    std::ostringstream os;
+    os << collect.adjacents;
+
+    std::string actual = os.str();
+    std::string expected = "x {0 }  x {2 aca {0 } acc {0 } } ";
+
+    std::cout << "Test 13 : ";
+    if (actual == expected && collect.adjacents == getAdjacents(&tree))
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Wide tree filled on several threads matches the sequential fill
+void test14()
+{
+    auto build = [](AI::TreeNode& tree)
+    {
+        for (int i = 0; i < 64; ++i)
+        {
+            tree.children.push_back(new AI::TreeNode{ i % 8 ? "x" : "b", &tree });
+            AI::TreeNode* child = tree.children.back();
+            for (int k = 0; k < 256; ++k)
+            {
+                child->children.push_back(new AI::TreeNode{ k % 5 ? "x" : "c", child });
+                AI::TreeNode* leaf = child->children.back();
+                for (int m = 0; m < 4; ++m)
+                    leaf->children.push_back(new AI::TreeNode{ "x", leaf });
+            }
+        }
+    };
+
+    AI::TreeNode tree{ "a" };
+    AI::TreeNode copy{ "a" };
+    build(tree);
+    build(copy);
+
+    AI::GetTreeAdjacents getAdjacents;
+
+    AI::Flood_Fill_Parallel(&getAdjacents, 4, 16).run(&tree, "z");
+    AI::Flood_Fill_Iterative<AI::Stack>(&getAdjacents).run(&copy, "z");
+
+    std::string actual = tree.getAsString();
+    std::string expected = copy.getAsString();
+
+    std::cout << "Test 14 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+void test15()
+{
+    std::istringstream istream{"\
+a {3\
+ aa {1 x {0 } }\
+ x {2 aba {1 x {0 } } x {0 } }\
+ ac {0 } } "};
+
+    AI::TreeNode tree;
+
+    istream >> tree;
+
+    AI::PreorderTree flat(&tree);
+    std::size_t filled = flat.fill(0, "z");
+    flat.store();
+
+    std::ostringstream os;
+    os << tree;
+
+    std::string actual = os.str();
+    std::string expected = "a {3 aa {1 x {0 } } z {2 aba {1 x {0 } } z {0 } } ac {0 } } ";
+
+    std::cout << "Test 15 : ";
+    if (actual == expected && filled == 2 && flat.size() == 8)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Equal seeds replay the same shuffles and shuffling fills run in parallel
+void test16()
+{
+    AI::TreeNode tree{ "a" };
+    for (int i = 0; i < 16; ++i)
+    {
+        tree.children.push_back(new AI::TreeNode{ "x", &tree });
+        for (int k = 0; k < 64; ++k)
+            tree.children.back()->children.push_back(new AI::TreeNode{ "x", tree.children.back() });
+    }
+
+    AI::GetTreeStochasticAdjacents a{ AI::Random{ 7 } };
+    AI::GetTreeStochasticAdjacents b{ AI::Random{ 7 } };
+
+    bool replayed = true;
+    for (int n = 0; n < 8; ++n)
+        replayed = replayed && a(&tree) == b(&tree);
+
+    AI::Flood_Fill_Parallel(&a, 4, 8).run(&tree, "z");
+
+    int filled = 0;
+    for (auto child : tree.children)
+    {
+        filled += (child->value == "z");
+        for (auto leaf : child->children)
+            filled += (leaf->value == "z");
+    }
+
+    std::cout << "Test 16 : ";
+    if (replayed && a(&tree).empty() && filled == 16 * 65)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << filled << ')' << std::endl;
+}
+
+// A queue that never drains keeps memory in line with its frontier
+void test17()
+{
+    AI::TreeNode nodes[8];
+    AI::Queue queue;
+
+    // A frontier of 8 nodes cycled far more often than it is long
+    for (auto& node : nodes)
+        queue.push(&node);
+
+    bool ordered = true;
+    for (int n = 0; n < 100000; ++n)
+    {
+        AI::TreeNode* pNode = queue.pop();
+        ordered = ordered && pNode == &nodes[n % 8];
+        queue.push(pNode);
+    }
+
+    std::size_t stored = queue.p_Node.size();
+    std::size_t capacity = queue.p_Node.capacity();
+
+    std::cout << "Test 17 : ";
+    if (ordered && stored <= 2 * 64 && capacity <= 4 * 64)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << stored << ')' << std::endl;
+}
@@ -0,0 +1,361 @@
+/*!*****************************************************************************
+\file bench.cpp
+\author Chen Yen Hsun
+\par DP email: c.yenhsun\@digipen.edu
+\par Course: CS380
+\par Section: A
+\par Programming Assignment 4
+\date 05-28-2023
+\brief
+
+Benchmark for the path finding engines. Generates seeded open maps, open
+maps with scattered blocks and mazes, runs every engine from one corner to
+the other and reports the time, the path cost and the nodes expanded.
+Preprocessing, such as building the clusters of HPA* or the landmarks of
+ALT, is not timed. On the smaller maps a batch of seeded queries is also
+run on pools of 1, 2 and 4 threads, and the batch rows report the total
+moves of all its paths.
+
+    usage: bench.out [max size = 1024] [seed = 380]
+
+Copyright (C) 2022 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents
+without the prior written consent of DigiPen Institute of
+Technology is prohibited.
+*******************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include "functions.h"
+
+namespace
+{
+    const int WALL = 1;
+
+    // Queries per timed batch, and the largest map the batch is run on
+    const int BATCH_QUERIES = 32;
+    const int BATCH_MAX_SIZE = 256;
+
+    using Map = std::vector<int>;
+
+    /*!*****************************************************************************
+     * \brief
+        A map without obstacles. Every shortest path is equally good, which is
+        the worst case for Dijkstra and the best case for Jump Point Search.
+    *******************************************************************************/
+    Map makeOpen(int size, unsigned /*seed*/)
+    {
+        return Map(static_cast<std::size_t>(size) * size, 0);
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Rectangular blocks of random size, one per 8x8 tile. The first row and
+        column of every tile stay open, so all open cells are connected.
+    *******************************************************************************/
+    Map makeBlocks(int size, unsigned seed)
+    {
+        const int TILE = 8;
+        Map map(static_cast<std::size_t>(size) * size, 0);
+        std::mt19937 rng{ seed };
+
+        for (int tj = 0; tj < size; tj += TILE)
+            for (int ti = 0; ti < size; ti += TILE)
+            {
+                int height = 2 + static_cast<int>(rng() % (TILE - 3));
+                int width = 2 + static_cast<int>(rng() % (TILE - 3));
+                int j = tj + 1 + static_cast<int>(rng() % (TILE - height));
+                int i = ti + 1 + static_cast<int>(rng() % (TILE - width));
+                for (int y = j; y < j + height && y < size; ++y)
+                    for (int x = i; x < i + width && x < size; ++x)
+                        map[static_cast<std::size_t>(y) * size + x] = WALL;
+            }
+
+        return map;
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Perfect maze carved by a randomized depth-first backtracker. There is a
+        single path between two cells, so pruning symmetric paths gains little.
+    *******************************************************************************/
+    Map makeMaze(int size, unsigned seed)
+    {
+        Map map(static_cast<std::size_t>(size) * size, WALL);
+        std::mt19937 rng{ seed };
+
+        struct Cell
+        {
+            int j, i;
+        };
+
+        const int cells = (size - 1) / 2; // maze cells per side on odd coordinates
+        std::vector<Cell> stack{ Cell{ 0, 0 } };
+        std::vector<char> seen(static_cast<std::size_t>(cells) * cells, 0);
+        seen[0] = 1;
+        map[static_cast<std::size_t>(1) * size + 1] = 0;
+
+        const int dj[] = { -1, 1, 0, 0 };
+        const int di[] = { 0, 0, -1, 1 };
+
+        while (!stack.empty())
+        {
+            Cell cell = stack.back();
+            int options[4];
+            int count = 0;
+
+            for (int d = 0; d < 4; ++d)
+            {
+                int j = cell.j + dj[d];
+                int i = cell.i + di[d];
+                if (j >= 0 && j < cells && i >= 0 && i < cells && !seen[j * cells + i])
+                    options[count++] = d;
+            }
+
+            if (count == 0)
+            {
+                stack.pop_back();
+                continue;
+            }
+
+            int d = options[rng() % count];
+            Cell next{ cell.j + dj[d], cell.i + di[d] };
+            seen[next.j * cells + next.i] = 1;
+
+            // Open the wall between the cells and the new cell itself
+            map[static_cast<std::size_t>(cell.j * 2 + 1 + dj[d]) * size + cell.i * 2 + 1 + di[d]] = 0;
+            map[static_cast<std::size_t>(next.j * 2 + 1) * size + next.i * 2 + 1] = 0;
+            stack.push_back(next);
+        }
+
+        return map;
+    }
+
+    struct Result
+    {
+        double seconds;
+        std::size_t moves;
+        long cost;
+        std::size_t expanded;
+        bool hasExpanded;
+    };
+
+    // Engines that count their expansions report them
+    template<typename Engine>
+    bool readExpanded(const Engine& engine, std::size_t& expanded)
+    {
+        expanded = engine.getExpanded();
+        return true;
+    }
+
+    bool readExpanded(const AI::Dijkstras&, std::size_t&)
+    {
+        return false;
+    }
+
+    bool readExpanded(const AI::GridDijkstras&, std::size_t&)
+    {
+        return false;
+    }
+
+    // Engines that allow diagonal steps report the cost themselves
+    template<typename Engine>
+    long readCost(const Engine&, const std::vector<char>& path)
+    {
+        return static_cast<long>(path.size()) * 10;
+    }
+
+    long readCost(const AI::JumpPointSearch& engine, const std::vector<char>&)
+    {
+        return engine.getCost();
+    }
+
+    // Engines on GetMapAdjacents are built from the functor, grid engines from the map
+    template<typename Engine>
+    struct Make
+    {
+        static Engine make(AI::GetMapAdjacents* getAdjacents, const Map&, int)
+        {
+            return Engine{ getAdjacents };
+        }
+    };
+
+    template<>
+    struct Make<AI::GridDijkstras>
+    {
+        static AI::GridDijkstras make(AI::GetMapAdjacents*, const Map& map, int size)
+        {
+            return AI::GridDijkstras{ map.data(), size };
+        }
+    };
+
+    template<>
+    struct Make<AI::JumpPointSearch>
+    {
+        static AI::JumpPointSearch make(AI::GetMapAdjacents*, const Map& map, int size)
+        {
+            return AI::JumpPointSearch{ map.data(), size };
+        }
+    };
+
+    template<>
+    struct Make<AI::HPAStar>
+    {
+        static AI::HPAStar make(AI::GetMapAdjacents*, const Map& map, int size)
+        {
+            return AI::HPAStar{ map.data(), size };
+        }
+    };
+
+    /*!*****************************************************************************
+     * \brief
+        Runs one engine between opposite corners of the map and measures it.
+        The query is run twice and the second one is timed, so engines that keep
+        their memory between queries are measured warm.
+    *******************************************************************************/
+    template<typename Engine>
+    Result measure(const Map& map, int size, Engine engine)
+    {
+        // The first and the last open cell in scan order
+        std::size_t first = 0;
+        std::size_t last = map.size() - 1;
+        while (first < last && map[first] != 0)
+            ++first;
+        while (last > first && map[last] != 0)
+            --last;
+        AI::Key start{ static_cast<int>(first / size), static_cast<int>(first % size) };
+        AI::Key target{ static_cast<int>(last / size), static_cast<int>(last % size) };
+
+        engine.run(start, target);
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<char> path = engine.run(start, target);
+        auto end = std::chrono::steady_clock::now();
+
+        Result result{};
+        result.seconds = std::chrono::duration<double>(end - begin).count();
+        result.moves = path.size();
+        result.cost = readCost(engine, path);
+        result.hasExpanded = readExpanded(engine, result.expanded);
+        return result;
+    }
+
+    template<typename Engine>
+    Result measure(Map& map, int size)
+    {
+        AI::GetMapAdjacents getAdjacents{ map.data(), size };
+        return measure(map, size, Make<Engine>::make(&getAdjacents, map, size));
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Runs a batch of seeded queries between open cells on a BatchDijkstras
+        pool and measures it. The batch is run twice and the second one is timed,
+        so the pool is measured with its threads started and its lists warm.
+    *******************************************************************************/
+    Result measureBatch(Map& map, int size, unsigned seed, unsigned threads)
+    {
+        std::vector<AI::Key> open;
+        for (std::size_t k = 0; k < map.size(); ++k)
+            if (map[k] == 0)
+                open.push_back(AI::Key{ static_cast<int>(k / size), static_cast<int>(k % size) });
+
+        std::mt19937 rng{ seed };
+        std::vector<std::pair<AI::Key, AI::Key>> queries;
+        for (int q = 0; q < BATCH_QUERIES; ++q)
+            queries.emplace_back(open[rng() % open.size()], open[rng() % open.size()]);
+
+        AI::GetMapAdjacents getAdjacents{ map.data(), size };
+        AI::BatchDijkstras batch{ &getAdjacents, threads };
+
+        batch.run(queries);
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<std::vector<char>> paths = batch.run(queries);
+        auto end = std::chrono::steady_clock::now();
+
+        Result result{};
+        result.seconds = std::chrono::duration<double>(end - begin).count();
+        for (const std::vector<char>& path : paths)
+            result.moves += path.size();
+        result.cost = static_cast<long>(result.moves) * 10;
+        return result;
+    }
+
+    void report(const char* mapName, int size, const char* engine, const Result& r)
+    {
+        std::cout << std::left << std::setw(8) << mapName
+            << std::right << std::setw(7) << size
+            << "  " << std::left << std::setw(12) << engine
+            << std::right << std::setw(12) << std::fixed << std::setprecision(2) << r.seconds * 1000.0
+            << std::setw(12) << r.moves
+            << std::setw(12) << r.cost;
+        if (r.hasExpanded)
+            std::cout << std::setw(12) << r.expanded;
+        else
+            std::cout << std::setw(12) << '-';
+        std::cout << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int maxSize = argc > 1 ? std::atoi(argv[1]) : 1024;
+    unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 380u;
+
+    struct Generator
+    {
+        const char* name;
+        Map(*make)(int, unsigned);
+    };
+    const Generator generators[] = {
+        { "open", makeOpen },
+        { "blocks", makeBlocks },
+        { "maze", makeMaze }
+    };
+
+    std::cout << std::left << std::setw(8) << "map"
+        << std::right << std::setw(7) << "size"
+        << "  " << std::left << std::setw(12) << "engine"
+        << std::right << std::setw(12) << "ms"
+        << std::setw(12) << "moves"
+        << std::setw(12) << "cost"
+        << std::setw(12) << "expanded" << std::endl;
+
+    for (int size = 64; size <= maxSize && size <= 4096; size *= 4)
+    {
+        for (const Generator& generator : generators)
+        {
+            Map map = generator.make(size, seed);
+
+            report(generator.name, size, "dijkstras", measure<AI::Dijkstras>(map, size));
+            report(generator.name, size, "grid", measure<AI::GridDijkstras>(map, size));
+            report(generator.name, size, "astar", measure<AI::AStar<>>(map, size));
+            report(generator.name, size, "jps", measure<AI::JumpPointSearch>(map, size));
+            report(generator.name, size, "hpa", measure<AI::HPAStar>(map, size));
+
+            // Diagonal steps are written as two moves, so compare the cost
+            report(generator.name, size, "jps-8",
+                measure(map, size, AI::JumpPointSearch{ map.data(), size, true }));
+
+            // Landmarks are picked once per map, outside the timed query
+            AI::GetMapAdjacents getAdjacents{ map.data(), size };
+            AI::Landmarks landmarks{ map.data(), size };
+            landmarks.build(16);
+            report(generator.name, size, "alt",
+                measure(map, size, AI::AStar<AI::LandmarkHeuristic>{ &getAdjacents, AI::LandmarkHeuristic{ &landmarks } }));
+
+            // The same queries on a growing pool
+            if (size <= BATCH_MAX_SIZE)
+            {
+                report(generator.name, size, "batch-1", measureBatch(map, size, seed, 1));
+                report(generator.name, size, "batch-2", measureBatch(map, size, seed, 2));
+                report(generator.name, size, "batch-4", measureBatch(map, size, seed, 4));
+            }
+        }
+    }
+
+    return 0;
+}
@@ -5,68 +5,146 @@
 #include <deque>
 #include <list>
 #include <vector>
+#include <memory>
+#include <algorithm>
 #include <initializer_list>
+#include <cstdint>
+#include <stdexcept>
 
 namespace AI
 {
-    // Key part from key-value pairs that are used in hash tables
-    class Key : public std::vector<int>
+    // Key part from key-value pairs that are used in hash tables. Elements
+    // are stored inline in a fixed array of N, so keys are never allocated
+    // and copying one is a plain memory copy. The hash is kept up to date on
+    // every change, so tables never hash a key twice.
+    template<std::size_t N>
+    class InlineKey
     {
+        int data[N];        // unused elements stay 0 so whole arrays compare
+        std::uint32_t count;
+        std::size_t h;      // hash of the used elements
+
     public:
-        Key(const std::initializer_list<int>& list)
+        static constexpr std::size_t CAPACITY = N;
+
+        // Throws std::length_error for more elements than the capacity
+        InlineKey(const std::initializer_list<int>& list = {})
+            : data{}, count{ 0 }, h{ SEED }
         {
             for (auto it = list.begin(); it != list.end(); ++it)
                 push_back(*it);
         }
 
+        std::size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        // Read only, so the cached hash cannot go stale; see set()
+        int operator[](std::size_t k) const { return data[k]; }
+
+        const int* begin() const { return data; }
+        const int* end() const { return data + count; }
+
+        int front() const { return data[0]; }
+
+        // A dropped element would make distinct keys equal, so overflow throws
+        void push_back(int v)
+        {
+            if (count == N)
+                throw std::length_error("InlineKey capacity exceeded");
+            data[count++] = v;
+            h = mix(h, v);
+        }
+
         int pop() 
         {
+            if (count == 0)
+                throw std::out_of_range("InlineKey is empty");
             int n = front();
-            erase(begin());
+            std::copy(data + 1, data + count, data);
+            data[--count] = 0;
+
+            h = SEED;
+            for (int v : *this)
+                h = mix(h, v);
             return n;
         }
 
-        bool operator==(const Key& rhs) const
+        // Writes an element in place and updates the hash
+        void set(std::size_t k, int v)
+        {
+            data[k] = v;
+            h = SEED;
+            for (int e : *this)
+                h = mix(h, e);
+        }
+
+        std::size_t hash() const { return h; }
+
+        // Fixed size loop over the whole array, which compilers vectorize
+        bool operator==(const InlineKey& rhs) const
         {
-            if (size() != rhs.size())
+            if (h != rhs.h || count != rhs.count)
                 return false;
 
-            for (auto ia = begin(), ib = rhs.begin(); ia != end(); ++ia, ++ib)
-                if (*ia != *ib)
-                    return false;
+            bool same = true;
+            for (std::size_t k = 0; k < N; ++k)
+                same &= data[k] == rhs.data[k];
+            return same;
+        }
 
-            return true;
+        bool operator!=(const InlineKey& rhs) const
+        {
+            return !operator==(rhs);
         }
 
-        friend std::ostream& operator<<(std::ostream& os, const Key& rhs)
+        friend std::ostream& operator<<(std::ostream& os, const InlineKey& rhs)
         {
             for (auto it = rhs.begin(); it != rhs.end(); ++it)
                 os << *it << (it + 1 != rhs.end() ? "," : "");
             return os;
         }
+
+    private:
+        static constexpr std::uint64_t SEED = 0x9e3779b97f4a7c15ULL;
+
+        // Mixes one element so that neighboring keys land far apart
+        static std::size_t mix(std::uint64_t h, int v)
+        {
+            h ^= static_cast<std::uint32_t>(v);
+            h *= 0xbf58476d1ce4e5b9ULL;
+            h ^= h >> 31;
+            return static_cast<std::size_t>(h);
+        }
     };
 
+    // Grid coordinates [j, i]
+    using GridKey = InlineKey<2>;
+
+    // Default key, large enough for 4x4 sliding puzzle states
+    using Key = InlineKey<16>;
+
     // Node is used to keep track of visited nodes or nodes to be visited 
     // during search
-    class Node
+    template<typename K>
+    class BasicNode
     {
     public:
-        Key key;
+        K key;
         int g;
         char info;
-        Node* parent;
+        BasicNode* parent;
 
-        Node(Key key = {}, int g = 0, char info = ' ', Node* parent = nullptr)
+        BasicNode(K key = {}, int g = 0, char info = ' ', BasicNode* parent = nullptr)
             : key(key), g{ g }, info{ info }, parent{ parent }
         {
         }
 
-        static bool less(const Node* a, const Node* b) 
+        static bool less(const BasicNode* a, const BasicNode* b) 
         { 
             return a->g < b->g; 
         }
 
-        friend std::ostream& operator<<(std::ostream& os, const Node& rhs)
+        friend std::ostream& operator<<(std::ostream& os, const BasicNode& rhs)
         {
             os << rhs.key << ' ' << rhs.g << ' ' << rhs.info;
             if (rhs.parent)
@@ -75,6 +153,51 @@ namespace AI
         }
     };
 
+    using Node = BasicNode<Key>;
+
+    // Slab allocator for the nodes of one search. Nodes are handed out from
+    // blocks that never move, so pointers to them stay valid as the pool
+    // grows, and reset() frees all of them at once while keeping the blocks
+    // for the next search. Containers that hold pool nodes must release()
+    // them instead of clearing.
+    template<typename K = Key>
+    class NodePool
+    {
+        using Node = BasicNode<K>;
+
+        static const std::size_t BLOCK = 4096; // nodes per block
+
+        std::vector<std::unique_ptr<Node[]>> blocks;
+        std::size_t used; // nodes handed out since the last reset
+
+    public:
+        NodePool()
+            : blocks{}, used{ 0 }
+        {
+        }
+
+        NodePool(const NodePool&) = delete;
+        NodePool& operator=(const NodePool&) = delete;
+
+        std::size_t size() const { return used; }
+
+        Node* make(const K& key = {}, int g = 0, char info = ' ', Node* parent = nullptr)
+        {
+            if (used == blocks.size() * BLOCK)
+                blocks.emplace_back(new Node[BLOCK]);
+            Node* node = &blocks[used / BLOCK][used % BLOCK];
+            *node = Node(key, g, info, parent);
+            ++used;
+            return node;
+        }
+
+        // Frees every node at once
+        void reset()
+        {
+            used = 0;
+        }
+    };
+
 
     // Abstract base class for domain specific functors that return adjacent nodes
     class GetAdjacents
@@ -87,6 +210,35 @@ namespace AI
         }
 
         virtual std::vector<Node*> operator()(Key key) = 0;
+
+        // Writes the adjacent nodes into a vector the caller keeps between
+        // calls, so a search does not allocate a node per adjacent. The
+        // default copies and deletes the nodes of operator().
+        virtual void adjacents(Key key, std::vector<Node>& list)
+        {
+            list.clear();
+            for (Node* adjacent : operator()(key))
+            {
+                list.push_back(*adjacent);
+                delete adjacent;
+            }
+        }
+
+        // Returns the nodes that have an edge into the key, with the cost of
+        // that edge and the move that takes each node to the key. The default
+        // suits domains where every edge can be walked both ways at the same
+        // cost and moves have no direction.
+        virtual std::vector<Node*> reverse(Key key)
+        {
+            return operator()(key);
+        }
+
+        // Returns the largest cost of a single edge, or 0 if it is not known.
+        // Searches use it to pick a bucket queue over a comparison heap.
+        virtual int maxCost() const
+        {
+            return 0;
+        }
     };
 
 
@@ -171,7 +323,7 @@ namespace AI
             sort(Node::less);
         }
 
-        Node* find(Key key)
+        Node* find(const Key& key)
         {
             for (auto it = begin(); it != end(); ++it)
                 if ((*it)->key == key)
@@ -187,6 +339,541 @@ namespace AI
         }
     };
 
+    // Hash map from keys to values with open addressing in one flat array.
+    // Keys are found by linear probing from their hash, which is stored next
+    // to them so most mismatches cost no key comparison. clear() forgets all
+    // entries in constant time by bumping a generation number, so the memory
+    // is reused by the next search instead of being freed.
+    template<typename V, typename K = Key>
+    class FlatMap
+    {
+        struct Slot
+        {
+            K key;
+            std::size_t hash;
+            unsigned generation; // slot is used if it equals the map's
+            V value;
+        };
+
+        std::vector<Slot> slots;
+        std::vector<std::size_t> used; // indices of used slots
+        unsigned generation;
+
+    public:
+        FlatMap(std::size_t capacity = 64)
+            : slots{}, used{}, generation{ 1 }
+        {
+            reserve(capacity);
+        }
+
+        std::size_t size() const { return used.size(); }
+
+        // Makes room for n entries without growing
+        void reserve(std::size_t n)
+        {
+            std::size_t capacity = 16;
+            while (capacity < 2 * n)
+                capacity *= 2;
+            if (capacity > slots.size())
+                rehash(capacity);
+        }
+
+        void clear()
+        {
+            used.clear();
+            if (++generation == 0)
+            {
+                // Stamps wrapped around, so old slots could look used again
+                for (auto& slot : slots)
+                    slot.generation = 0;
+                generation = 1;
+            }
+        }
+
+        V* find(const K& key)
+        {
+            std::size_t k = locate(key, key.hash());
+            return slots[k].generation == generation ? &slots[k].value : nullptr;
+        }
+
+        const V* find(const K& key) const
+        {
+            std::size_t k = locate(key, key.hash());
+            return slots[k].generation == generation ? &slots[k].value : nullptr;
+        }
+
+        // Returns the value of key, inserting a default value if it is new
+        V& operator[](const K& key)
+        {
+            std::size_t hash = key.hash();
+            std::size_t k = locate(key, hash);
+            if (slots[k].generation == generation)
+                return slots[k].value;
+
+            if (2 * (used.size() + 1) > slots.size())
+            {
+                rehash(slots.size() * 2);
+                k = locate(key, hash);
+            }
+
+            slots[k].key = key;
+            slots[k].hash = hash;
+            slots[k].generation = generation;
+            slots[k].value = V{};
+            used.push_back(k);
+            return slots[k].value;
+        }
+
+        // Calls f(key, value) for every entry
+        template<typename F>
+        void forEach(F f)
+        {
+            for (std::size_t k : used)
+                f(slots[k].key, slots[k].value);
+        }
+
+    private:
+        // Slot that holds key, or the empty slot where it would go
+        std::size_t locate(const K& key, std::size_t hash) const
+        {
+            const std::size_t mask = slots.size() - 1;
+            std::size_t k = hash & mask;
+            while (slots[k].generation == generation
+                && (slots[k].hash != hash || !(slots[k].key == key)))
+                k = (k + 1) & mask;
+            return k;
+        }
+
+        void rehash(std::size_t capacity)
+        {
+            std::vector<Slot> old(capacity);
+            old.swap(slots);
+            std::vector<std::size_t> entries;
+            entries.swap(used);
+            unsigned oldGeneration = generation;
+            generation = 1;
+
+            used.reserve(entries.size());
+            for (std::size_t e : entries)
+            {
+                Slot& slot = old[e];
+                if (slot.generation != oldGeneration)
+                    continue;
+                std::size_t k = locate(slot.key, slot.hash);
+                slots[k] = std::move(slot);
+                slots[k].generation = generation;
+                used.push_back(k);
+            }
+        }
+    };
+
+    // Closed list with the interface of HashTable on top of FlatMap. It owns
+    // the nodes it holds; clear() deletes them but keeps the table's memory.
+    template<typename K = Key>
+    class FlatHashTable
+    {
+        using Node = BasicNode<K>;
+
+        FlatMap<Node*, K> map;
+
+    public:
+        FlatHashTable(std::size_t capacity = 1024)
+            : map{ capacity }
+        {
+        }
+
+        FlatHashTable(const FlatHashTable&) = delete;
+        FlatHashTable& operator=(const FlatHashTable&) = delete;
+
+        ~FlatHashTable()
+        {
+            clear();
+        }
+
+        std::size_t size() const { return map.size(); }
+
+        void reserve(std::size_t n) { map.reserve(n); }
+
+        void clear()
+        {
+            map.forEach([](const K&, Node*& value) { delete value; });
+            map.clear();
+        }
+
+        // Forgets the nodes without deleting them, for nodes owned by a NodePool
+        void release()
+        {
+            map.clear();
+        }
+
+        void add(const K& key, Node* v)
+        {
+            Node*& value = map[key];
+            if (value)
+                delete value;
+            value = v;
+        }
+
+        Node* find(const K& key) const
+        {
+            Node* const* value = map.find(key);
+            return value ? *value : nullptr;
+        }
+    };
+
+    // Priority queue of nodes kept as a 4-ary heap in a vector. A position map
+    // from key to heap slot gives constant time find() and lets decrease()
+    // move a node up in O(log n). Nodes with equal priority leave in the
+    // order they were pushed, like in PriorityQueue.
+    template<typename K = Key>
+    class IndexedHeap
+    {
+        using Node = BasicNode<K>;
+
+        static const std::size_t D = 4;
+
+        struct Entry
+        {
+            Node* node;
+            int f;                  // priority
+            int tie;                // secondary priority for equal f
+            unsigned long long age; // push order for equal f and tie
+        };
+
+        static const std::size_t NONE = static_cast<std::size_t>(-1);
+
+        std::vector<Entry> heap;
+        FlatMap<std::size_t, K> position; // heap slot of each key, NONE once popped
+        unsigned long long pushes;
+
+    public:
+        IndexedHeap(std::size_t capacity = 1024)
+            : heap{}, position{ capacity }, pushes{ 0 }
+        {
+            heap.reserve(capacity);
+        }
+
+        IndexedHeap(const IndexedHeap&) = delete;
+        IndexedHeap& operator=(const IndexedHeap&) = delete;
+
+        ~IndexedHeap()
+        {
+            clear();
+        }
+
+        bool empty() const { return heap.empty(); }
+
+        std::size_t size() const { return heap.size(); }
+
+        // Deletes the nodes still in the queue and keeps the memory
+        void clear()
+        {
+            for (auto& e : heap)
+                delete e.node;
+            release();
+        }
+
+        // Forgets the nodes without deleting them, for nodes owned by a NodePool
+        void release()
+        {
+            heap.clear();
+            position.clear();
+            pushes = 0;
+        }
+
+        void push(Node* node)
+        {
+            push(node, node->g);
+        }
+
+        void push(Node* node, int f, int tie = 0)
+        {
+            heap.push_back(Entry{ node, f, tie, pushes++ });
+            position[node->key] = heap.size() - 1;
+            up(heap.size() - 1);
+        }
+
+        Node* pop()
+        {
+            Node* node = heap.front().node;
+            position[node->key] = NONE;
+            if (heap.size() > 1)
+            {
+                heap.front() = heap.back();
+                position[heap.front().node->key] = 0;
+                heap.pop_back();
+                down(0);
+            }
+            else
+                heap.pop_back();
+            return node;
+        }
+
+        Node* top() const
+        {
+            return heap.front().node;
+        }
+
+        int topPriority() const
+        {
+            return heap.front().f;
+        }
+
+        int topTie() const
+        {
+            return heap.front().tie;
+        }
+
+        Node* find(const K& key) const
+        {
+            const std::size_t* k = position.find(key);
+            return (k && *k != NONE) ? heap[*k].node : nullptr;
+        }
+
+        // Lowers the priority of a node that is in the queue
+        void decrease(Node* node, int f, int tie = 0)
+        {
+            std::size_t k = *position.find(node->key);
+            heap[k].f = f;
+            heap[k].tie = tie;
+            up(k);
+        }
+
+        // Moves a node that is in the queue to a higher or lower priority
+        void update(Node* node, int f, int tie = 0)
+        {
+            std::size_t k = *position.find(node->key);
+            Entry e{ node, f, tie, heap[k].age };
+            bool raise = less(e, heap[k]);
+            heap[k] = e;
+            if (raise)
+                up(k);
+            else
+                down(k);
+        }
+
+        // Takes a node out of the queue without deleting it
+        void erase(Node* node)
+        {
+            std::size_t* slot = position.find(node->key);
+            std::size_t k = *slot;
+            *slot = NONE;
+            if (k + 1 == heap.size())
+            {
+                heap.pop_back();
+                return;
+            }
+
+            Entry last = heap.back();
+            heap.pop_back();
+            bool raise = less(last, heap[k]);
+            place(k, last);
+            if (raise)
+                up(k);
+            else
+                down(k);
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const IndexedHeap& rhs)
+        {
+            for (auto& e : rhs.heap)
+                os << *e.node << "  ";
+            return os;
+        }
+
+    private:
+        static bool less(const Entry& a, const Entry& b)
+        {
+            if (a.f != b.f)
+                return a.f < b.f;
+            if (a.tie != b.tie)
+                return a.tie < b.tie;
+            return a.age < b.age;
+        }
+
+        void place(std::size_t k, const Entry& e)
+        {
+            heap[k] = e;
+            position[e.node->key] = k;
+        }
+
+        void up(std::size_t k)
+        {
+            Entry e = heap[k];
+            while (k > 0)
+            {
+                std::size_t parent = (k - 1) / D;
+                if (!less(e, heap[parent]))
+                    break;
+                place(k, heap[parent]);
+                k = parent;
+            }
+            place(k, e);
+        }
+
+        void down(std::size_t k)
+        {
+            Entry e = heap[k];
+            const std::size_t n = heap.size();
+            while (true)
+            {
+                std::size_t first = k * D + 1;
+                if (first >= n)
+                    break;
+                std::size_t best = first;
+                std::size_t last = std::min(first + D, n);
+                for (std::size_t c = first + 1; c < last; ++c)
+                    if (less(heap[c], heap[best]))
+                        best = c;
+                if (!less(heap[best], e))
+                    break;
+                place(k, heap[best]);
+                k = best;
+            }
+            place(k, e);
+        }
+    };
+
+    // Monotone priority queue of nodes for small integer edge costs (Dial's
+    // algorithm). Priorities in the queue lie within maxCost of the last one
+    // popped, so a ring of maxCost + 1 FIFO buckets holds them and push, pop
+    // and decrease are O(1) amortized. decrease() blanks the old entry and
+    // pop() skips it. Nodes with equal priority leave in push order.
+    template<typename K = Key>
+    class BucketQueue
+    {
+        using Node = BasicNode<K>;
+
+        struct Bucket
+        {
+            std::vector<Node*> entries; // nullptr where a node moved out
+            std::size_t head;           // entries before it were popped
+        };
+
+        struct Slot
+        {
+            Node* node;        // nullptr once popped
+            int f;
+            std::size_t entry; // index of the node in its bucket
+        };
+
+        std::vector<Bucket> buckets;
+        FlatMap<Slot, K> position;
+        std::size_t count; // nodes in the queue
+        int current;       // priority of the last pop, nothing queued is lower
+
+    public:
+        BucketQueue(int maxCost = 1, std::size_t capacity = 1024)
+            : buckets{}, position{ capacity }, count{ 0 }, current{ 0 }
+        {
+            reset(maxCost);
+        }
+
+        BucketQueue(const BucketQueue&) = delete;
+        BucketQueue& operator=(const BucketQueue&) = delete;
+
+        ~BucketQueue()
+        {
+            clear();
+        }
+
+        bool empty() const { return count == 0; }
+
+        std::size_t size() const { return count; }
+
+        // Empties the queue and sizes the ring for a new largest edge cost
+        void reset(int maxCost)
+        {
+            clear();
+            buckets.resize(static_cast<std::size_t>(maxCost) + 1);
+        }
+
+        // Deletes the nodes still in the queue and keeps the memory
+        void clear()
+        {
+            position.forEach([](const K&, Slot& slot) { delete slot.node; });
+            release();
+        }
+
+        // Forgets the nodes without deleting them, for nodes owned by a NodePool
+        void release()
+        {
+            for (auto& bucket : buckets)
+            {
+                bucket.entries.clear();
+                bucket.head = 0;
+            }
+            position.clear();
+            count = 0;
+            current = 0;
+        }
+
+        void push(Node* node)
+        {
+            push(node, node->g);
+        }
+
+        // f must lie within maxCost above the last priority popped
+        void push(Node* node, int f)
+        {
+            if (count == 0 || f < current)
+                current = f;
+            position[node->key] = Slot{ node, f, append(node, f) };
+            ++count;
+        }
+
+        Node* pop()
+        {
+            while (true)
+            {
+                Bucket& b = bucket(current);
+                while (b.head < b.entries.size())
+                {
+                    Node* node = b.entries[b.head++];
+                    if (node)
+                    {
+                        position.find(node->key)->node = nullptr;
+                        --count;
+                        return node;
+                    }
+                }
+                b.entries.clear();
+                b.head = 0;
+                ++current;
+            }
+        }
+
+        Node* find(const K& key) const
+        {
+            const Slot* slot = position.find(key);
+            return slot ? slot->node : nullptr;
+        }
+
+        // Lowers the priority of a node that is in the queue
+        void decrease(Node* node, int f)
+        {
+            Slot& slot = *position.find(node->key);
+            bucket(slot.f).entries[slot.entry] = nullptr;
+            if (f < current)
+                current = f;
+            slot.f = f;
+            slot.entry = append(node, f);
+        }
+
+    private:
+        Bucket& bucket(int f)
+        {
+            return buckets[static_cast<std::size_t>(f) % buckets.size()];
+        }
+
+        std::size_t append(Node* node, int f)
+        {
+            Bucket& b = bucket(f);
+            b.entries.push_back(node);
+            return b.entries.size() - 1;
+        }
+    };
+
 } // end namespace
 
 #endif
\ No newline at end of file
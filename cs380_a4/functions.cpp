@@ -17,6 +17,19 @@ Technology is prohibited.
 *******************************************************************************/
 #include "functions.h"
 
+#include <cmath>
+#include <limits>
+#include <deque>
+#include <fstream>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace AI
 {
     /*!*****************************************************************************
@@ -52,6 +65,72 @@ namespace AI
         return list;
     }
 
+    /*!*****************************************************************************
+     * \brief
+        Find and return all empty cells that can move into a cell
+     *
+     * \param key
+        The key for which the previous nodes are to be retrieved.
+     *
+     * \return
+        A vector of pointers to AI::Node objects whose moves lead into the key.
+    *******************************************************************************/
+    std::vector<AI::Node*> GetMapAdjacents::reverse(Key key)
+    {
+        std::vector<AI::Node*> list = {};
+
+        // Moves are undirected between empty cells, only the move names flip;
+        // nothing can move into a wall
+        int j = key[0];
+        int i = key[1];
+
+        if (j >= 0 && j < this->size && i >= 0 && i < this->size
+            && this->map[j * this->size + i] == 0)
+        {
+            if (i > 0 && this->map[j * this->size + i - 1] == 0)
+                list.emplace_back(new Node(Key{ j, i - 1 }, 10, 'E'));
+            if (i < this->size - 1 && this->map[j * this->size + i + 1] == 0)
+                list.emplace_back(new Node(Key{ j, i + 1 }, 10, 'W'));
+            if (j > 0 && this->map[(j - 1) * this->size + i] == 0)
+                list.emplace_back(new Node(Key{ j - 1, i }, 10, 'S'));
+            if (j < this->size - 1 && this->map[(j + 1) * this->size + i] == 0)
+                list.emplace_back(new Node(Key{ j + 1, i }, 10, 'N'));
+        }
+
+        return list;
+    }
+
+    /*!*****************************************************************************
+     * \brief
+        Find all empty adjacent cells without allocating nodes
+     *
+     * \param key
+        The key for which adjacent nodes are to be retrieved.
+     *
+     * \param list
+        The vector that receives the adjacent nodes, replacing its contents.
+    *******************************************************************************/
+    void GetMapAdjacents::adjacents(Key key, std::vector<AI::Node>& list)
+    {
+        list.clear();
+
+        // Same cells in the same order as operator()
+        int j = key[0];
+        int i = key[1];
+
+        if (j >= 0 && j < this->size && i >= 0 && i < this->size)
+        {
+            if (i > 0 && this->map[j * this->size + i - 1] == 0)
+                list.emplace_back(Key{ j, i - 1 }, 10, 'W');
+            if (i < this->size - 1 && this->map[j * this->size + i + 1] == 0)
+                list.emplace_back(Key{ j, i + 1 }, 10, 'E');
+            if (j > 0 && this->map[(j - 1) * this->size + i] == 0)
+                list.emplace_back(Key{ j - 1, i }, 10, 'N');
+            if (j < this->size - 1 && this->map[(j + 1) * this->size + i] == 0)
+                list.emplace_back(Key{ j + 1, i }, 10, 'S');
+        }
+    }
+
     /*!*****************************************************************************
      * @brief Runs Dijkstra's algorithm to find the path from the starting position to the target position.
      *
@@ -67,62 +146,105 @@ namespace AI
     *******************************************************************************/
 	std::vector<char> Dijkstras::run(Key starting, Key target)
 	{
-        // Initialize closedlist and openlist
-        HashTable* closedlist = new HashTable();
-        PriorityQueue* openlist = new PriorityQueue();
+        int maxCost = this->pGetAdjacents->maxCost();
+        Node* pCurrent = nullptr;
+        expanded = 0;
+        AI_STATS(stats = SearchStats{});
+        AI_STATS(auto begin = std::chrono::steady_clock::now());
+
+        // Small integer costs keep the open list in a ring of buckets
+        if (maxCost > 0 && maxCost <= MAX_BUCKETS)
+        {
+            buckets.reset(maxCost);
+            pCurrent = search(buckets, starting, target);
+        }
+        else
+            pCurrent = search(openlist, starting, target);
+
+        AI_STATS(auto searched = std::chrono::steady_clock::now());
+        AI_STATS(stats.expanded = expanded);
+        AI_STATS(stats.closed = closedlist.size());
+
+        auto pCurr = getPath(pCurrent);
+
+        // Free the nodes at once and keep the memory of the lists for the next run
+        openlist.release();
+        buckets.release();
+        closedlist.release();
+        pool.reset();
+
+        AI_STATS(stats.searchSeconds = std::chrono::duration<double>(searched - begin).count());
+        AI_STATS(stats.pathSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - searched).count());
+        return pCurr;
+	}
 
+    /*!*****************************************************************************
+     * @brief Searches with the given open list until the target is closed.
+     *
+     * @param open
+     *     The empty open list to use.
+     *
+     * @param starting
+     *     An array of 2 elements [j, i] representing the starting position on the map.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+     *
+     * @return
+     *     The closed target node, or nullptr if it cannot be reached.
+    *******************************************************************************/
+    template<typename Q>
+    Node* Dijkstras::search(Q& open, const Key& starting, const Key& target)
+    {
         Node* pCurrent = nullptr;
 
-        openlist->push(new Node(starting));
+        open.push(pool.make(starting));
 
         // Implement the search
         while (true) {
 
-            if (openlist->empty()) {
+            if (open.empty()) {
 
                 pCurrent = nullptr;
                 break;
             }
 
-            pCurrent = openlist->pop();
+            pCurrent = open.pop();
 
-            closedlist->add(pCurrent->key, pCurrent);
+            closedlist.add(pCurrent->key, pCurrent);
 
             if (compareArrays(pCurrent->key, target))
                 break;
+            ++expanded;
 
-            std::vector<Node*> adjacents = this->pGetAdjacents->operator()(pCurrent->key);
-            for (Node* adjacent : adjacents)
+            this->pGetAdjacents->adjacents(pCurrent->key, adjacents);
+            AI_STATS(stats.generated += adjacents.size());
+            for (const Node& adjacent : adjacents)
             {
-                if (!closedlist->find(adjacent->key))
+                if (!closedlist.find(adjacent.key))
                 {
-                    Node* openlist_found = openlist->find(adjacent->key);
+                    int tentative_g = pCurrent->g + adjacent.g;
+                    Node* openlist_found = open.find(adjacent.key);
                     if (!openlist_found)
-                        openlist->push(new Node(adjacent->key,
-                            pCurrent->g + adjacent->g,
-                            adjacent->info,
+                        open.push(pool.make(adjacent.key,
+                            tentative_g,
+                            adjacent.info,
                             pCurrent));
-                    else
+                    else if (tentative_g < openlist_found->g)
                     {
-                        int tentative_g = pCurrent->g + adjacent->g;
-                        if (tentative_g < openlist_found->g)
-                        {
-                            openlist_found->parent = pCurrent;
-                            openlist_found->info = pCurrent->info;
-                            openlist_found->g = tentative_g;
-                        }
+                        openlist_found->parent = pCurrent;
+                        openlist_found->info = adjacent.info;
+                        openlist_found->g = tentative_g;
+                        open.decrease(openlist_found, tentative_g);
+                        AI_STATS(++stats.decreased);
                     }
                 }
-                delete adjacent;
             }
+            AI_STATS(stats.peakOpen = std::max(stats.peakOpen, open.size()));
         }
 
-        auto pCurr = getPath(pCurrent);
-
-        delete openlist;
-        delete closedlist;
-        return pCurr;
-	}
+        return pCurrent;
+    }
 
     /*!*****************************************************************************
      * @brief Retrieves the path from a given node to the starting point.
@@ -135,9 +257,27 @@ namespace AI
      *     Each character represents a movement direction
     *******************************************************************************/
     std::vector<char> Dijkstras::getPath(Node* pNode)
+    {
+        return tracePath(pNode);
+    }
+
+    /*!*****************************************************************************
+     * @brief Retrieves the moves from the starting point to a node.
+     *
+     * @param pNode
+     *     Pointer to the last node of the path, or nullptr if there is no path.
+     *
+     * @return
+     *     A vector of characters representing the moves along the parent links.
+    *******************************************************************************/
+    std::vector<char> tracePath(const Node* pNode)
     {
         std::vector<char> a{};
 
+        // Target was not reached
+        if (!pNode)
+            return a;
+
         // Trace back to return a vector of moves (.info)
         while (pNode) {
             a.push_back(pNode->info);
@@ -162,15 +302,2935 @@ namespace AI
      * @return
      *     `true` if the arrays are equal, `false` otherwise.
     *******************************************************************************/
-    bool Dijkstras::compareArrays(Key current, Key target)
+    bool Dijkstras::compareArrays(const Key& current, const Key& target)
     {
-        if (current == target)
-            return true;
+        return current == target;
+    }
 
-        if (target[1] >= 5)
-            return true;
+    /*!*****************************************************************************
+     * @brief Runs both searches to find the path from the starting position to the target position.
+     *
+     * @param starting
+     *     An array of 2 elements [j, i] representing the starting position on the map.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+     *
+     * @return
+     *     A vector of characters representing the path from the starting position to the target position.
+    *******************************************************************************/
+    std::vector<char> BidirectionalDijkstras::run(Key starting, Key target)
+    {
+        expanded = 0;
+        best = std::numeric_limits<int>::max();
+        meetForward = meetBackward = nullptr;
+        meetMove = 0;
+
+        if (starting == target)
+            return {};
+
+        forward.push(new Node(starting));
+        backward.push(new Node(target));
+
+        // No path through an unsettled node can beat the best one any more
+        while (!forward.empty() && !backward.empty()
+            && static_cast<long long>(forward.topPriority()) + backward.topPriority() < best)
+            expand(forward.topPriority() <= backward.topPriority());
+
+        std::vector<char> path{};
+        if (meetForward)
+        {
+            path = tracePath(meetForward);
+            path.push_back(meetMove);
+            // Parents on the target side lead towards the target
+            for (const Node* pNode = meetBackward; pNode->parent; pNode = pNode->parent)
+                path.push_back(pNode->info);
+        }
+
+        // Free the nodes but keep the memory of all lists for the next run
+        forward.clear();
+        backward.clear();
+        forwardClosed.clear();
+        backwardClosed.clear();
+        return path;
+    }
+
+    /*!*****************************************************************************
+     * @brief Expands the top node of one side and records any path that meets the other side.
+     *
+     * @param isForward
+     *     Expands the search from the start if true, the one from the target otherwise.
+    *******************************************************************************/
+    void BidirectionalDijkstras::expand(bool isForward)
+    {
+        IndexedHeap<>& openlist = isForward ? forward : backward;
+        FlatHashTable<>& closedlist = isForward ? forwardClosed : backwardClosed;
+        IndexedHeap<>& otherOpen = isForward ? backward : forward;
+        FlatHashTable<>& otherClosed = isForward ? backwardClosed : forwardClosed;
+
+        Node* pCurrent = openlist.pop();
+        closedlist.add(pCurrent->key, pCurrent);
+        ++expanded;
+
+        std::vector<Node*> adjacents = isForward
+            ? this->pGetAdjacents->operator()(pCurrent->key)
+            : this->pGetAdjacents->reverse(pCurrent->key);
+        for (Node* adjacent : adjacents)
+        {
+            if (!closedlist.find(adjacent->key))
+            {
+                int tentative_g = pCurrent->g + adjacent->g;
+                Node* openlist_found = openlist.find(adjacent->key);
+                if (!openlist_found)
+                    openlist.push(new Node(adjacent->key,
+                        tentative_g,
+                        adjacent->info,
+                        pCurrent));
+                else if (tentative_g < openlist_found->g)
+                {
+                    openlist_found->parent = pCurrent;
+                    openlist_found->info = adjacent->info;
+                    openlist_found->g = tentative_g;
+                    openlist.decrease(openlist_found, tentative_g);
+                }
+            }
+
+            // The edge joins the two searches
+            Node* other = otherClosed.find(adjacent->key);
+            if (!other)
+                other = otherOpen.find(adjacent->key);
+            if (other && pCurrent->g + adjacent->g + other->g < best)
+            {
+                best = pCurrent->g + adjacent->g + other->g;
+                meetForward = isForward ? pCurrent : other;
+                meetBackward = isForward ? other : pCurrent;
+                meetMove = adjacent->info;
+            }
+            delete adjacent;
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Constructs a BatchDijkstras object.
+     *
+     * @param pGetAdjacents
+     *     Pointer to a GetAdjacents object that provides the function to retrieve adjacent nodes.
+     *
+     * @param threads
+     *     Number of worker threads, 0 uses one per hardware thread.
+    *******************************************************************************/
+    BatchDijkstras::BatchDijkstras(GetAdjacents* pGetAdjacents, unsigned threads)
+        : workspaces{}, workers{}, mutex{}, wake{}, done{}
+        , generation{ 0 }, busy{ 0 }, stopping{ false }
+        , pQueries{ nullptr }, pPaths{ nullptr }, next{ 0 }
+    {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned k = 0; k < threads; ++k)
+            workspaces.emplace_back(new Dijkstras(pGetAdjacents));
+
+        // The calling thread is the first worker of every batch
+        for (unsigned k = 1; k < threads; ++k)
+            workers.emplace_back(&BatchDijkstras::serve, this, k);
+    }
+
+    /*!*****************************************************************************
+     * @brief Stops and joins the worker threads.
+    *******************************************************************************/
+    BatchDijkstras::~BatchDijkstras()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    /*!*****************************************************************************
+     * @brief Runs queries of the current batch until none is left.
+     *
+     * @param self
+     *     Index of the workspace of the calling thread.
+    *******************************************************************************/
+    void BatchDijkstras::drain(unsigned self)
+    {
+        // Each path has its own slot, so only the counter is shared
+        const std::vector<std::pair<Key, Key>>& queries = *pQueries;
+        std::vector<std::vector<char>>& paths = *pPaths;
+        Dijkstras& dijkstras = *workspaces[self];
+        for (std::size_t k = next.fetch_add(1, std::memory_order_relaxed); k < queries.size();
+            k = next.fetch_add(1, std::memory_order_relaxed))
+            paths[k] = dijkstras.run(queries[k].first, queries[k].second);
+    }
+
+    /*!*****************************************************************************
+     * @brief Body of a worker thread, waits for batches until the pool stops.
+     *
+     * @param self
+     *     Index of the workspace of the worker.
+    *******************************************************************************/
+    void BatchDijkstras::serve(unsigned self)
+    {
+        unsigned seen = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock{ mutex };
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+
+            drain(self);
+
+            std::lock_guard<std::mutex> lock{ mutex };
+            if (--busy == 0)
+                done.notify_one();
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Finds the paths of all queries.
+     *
+     * @param queries
+     *     Pairs of starting and target positions [j, i].
+     *
+     * @return
+     *     The path of every query, in the order of the queries.
+    *******************************************************************************/
+    std::vector<std::vector<char>> BatchDijkstras::run(const std::vector<std::pair<Key, Key>>& queries)
+    {
+        std::vector<std::vector<char>> paths(queries.size());
+        if (queries.empty())
+            return paths;
+
+        // The mutex publishes the batch to the workers and their paths back to the caller
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            pQueries = &queries;
+            pPaths = &paths;
+            next.store(0, std::memory_order_relaxed);
+            busy = static_cast<unsigned>(workers.size());
+            ++generation;
+        }
+        wake.notify_all();
+
+        drain(0);
+
+        std::unique_lock<std::mutex> lock{ mutex };
+        done.wait(lock, [&] { return busy == 0; });
+        pQueries = nullptr;
+        pPaths = nullptr;
+        return paths;
+    }
+
+    /*!*****************************************************************************
+     * @brief Constructs a PathCache object.
+     *
+     * @param pGetAdjacents
+     *     Pointer to a GetAdjacents object that provides the function to retrieve adjacent nodes.
+     *
+     * @param capacity
+     *     Number of paths kept before the least recently used one is evicted.
+    *******************************************************************************/
+    PathCache::PathCache(GetAdjacents* pGetAdjacents, std::size_t capacity)
+        : dijkstras{ pGetAdjacents }, capacity{ capacity }
+        , entries(capacity), unused{}, newest{ NONE }, oldest{ NONE }, live{ 0 }
+        , lookup{ capacity }, users{}, scratch{}, hits{ 0 }, misses{ 0 }
+    {
+        unused.reserve(capacity);
+        for (std::size_t e = capacity; e > 0; --e)
+            unused.push_back(e - 1);
+    }
+
+    /*!*****************************************************************************
+     * @brief Returns the cached path, searching for it only if it is not cached.
+     *
+     * @param starting
+     *     An array of 2 elements [j, i] representing the starting position on the map.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+     *
+     * @return
+     *     The moves from the starting position to the target position, valid until
+     *     the next call that changes the cache.
+    *******************************************************************************/
+    const std::vector<char>& PathCache::run(Key starting, Key target)
+    {
+        Key query{ starting[0], starting[1], target[0], target[1] };
+
+        std::size_t* found = lookup.find(query);
+        if (found && *found != NONE)
+        {
+            ++hits;
+            unlink(*found);
+            pushFront(*found);
+            return entries[*found].path;
+        }
+
+        ++misses;
+        scratch = dijkstras.run(starting, target);
+        if (capacity == 0 || (scratch.empty() && !(starting == target)))
+            return scratch;
+
+        if (live == capacity)
+            remove(oldest);
+        std::size_t e = unused.back();
+        unused.pop_back();
+
+        Entry& entry = entries[e];
+        entry.query = query;
+        entry.path.swap(scratch);
+        pushFront(e);
+        ++live;
+
+        // Dropped queries stay in the lookup, so rebuild it once they pile up
+        lookup[query] = e;
+        if (lookup.size() > 4 * capacity)
+        {
+            lookup.clear();
+            for (std::size_t k = newest; k != NONE; k = entries[k].next)
+                lookup[entries[k].query] = k;
+        }
+
+        // Register the path with every cell it crosses
+        int j = starting[0];
+        int i = starting[1];
+        for (std::size_t step = 0; step <= entry.path.size(); ++step)
+        {
+            if (step > 0)
+            {
+                char move = entry.path[step - 1];
+                i += (move == 'W') ? -1 : (move == 'E') ? 1 : 0;
+                j += (move == 'N') ? -1 : (move == 'S') ? 1 : 0;
+            }
+
+            std::vector<Ref>& refs = users[GridKey{ j, i }];
+            refs.push_back(Ref{ e, entry.stamp });
+
+            // Forget dropped paths now and then so busy cells stay short
+            if (refs.size() >= 8 && (refs.size() & (refs.size() - 1)) == 0)
+                refs.erase(std::remove_if(refs.begin(), refs.end(), [this](const Ref& ref)
+                    {
+                        return entries[ref.entry].stamp != ref.stamp;
+                    }), refs.end());
+        }
+
+        return entry.path;
+    }
+
+    /*!*****************************************************************************
+     * @brief Drops the cached paths that cross any of the edited cells.
+     *
+     * @param cells
+     *     The positions [j, i] of the cells that were changed on the map.
+    *******************************************************************************/
+    void PathCache::mapChanged(const std::vector<Key>& cells)
+    {
+        for (const Key& cell : cells)
+        {
+            std::vector<Ref>* refs = users.find(GridKey{ cell[0], cell[1] });
+            if (!refs)
+                continue;
+            for (const Ref& ref : *refs)
+                if (entries[ref.entry].stamp == ref.stamp)
+                    remove(ref.entry);
+            refs->clear();
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Makes an entry the most recently used one.
+    *******************************************************************************/
+    void PathCache::pushFront(std::size_t e)
+    {
+        entries[e].prev = NONE;
+        entries[e].next = newest;
+        if (newest != NONE)
+            entries[newest].prev = e;
+        newest = e;
+        if (oldest == NONE)
+            oldest = e;
+    }
+
+    /*!*****************************************************************************
+     * @brief Takes an entry out of the recently used order.
+    *******************************************************************************/
+    void PathCache::unlink(std::size_t e)
+    {
+        Entry& entry = entries[e];
+        if (entry.prev != NONE)
+            entries[entry.prev].next = entry.next;
+        else
+            newest = entry.next;
+        if (entry.next != NONE)
+            entries[entry.next].prev = entry.prev;
+        else
+            oldest = entry.prev;
+    }
+
+    /*!*****************************************************************************
+     * @brief Drops an entry and frees it for the next path.
+    *******************************************************************************/
+    void PathCache::remove(std::size_t e)
+    {
+        Entry& entry = entries[e];
+        *lookup.find(entry.query) = NONE;
+        ++entry.stamp;
+        entry.path.clear();
+        unlink(e);
+        unused.push_back(e);
+        --live;
+    }
+
+    /*!*****************************************************************************
+     * @brief Constructs a GridDijkstras object.
+     *
+     * @param map
+     *     A pointer to an array of integers representing the map.
+     *
+     * @param size
+     *     The width and height of the map in terms of the number of elements.
+    *******************************************************************************/
+    GridDijkstras::GridDijkstras(const int* map, int size)
+        : map{ map }, size{ size }
+        , g(static_cast<std::size_t>(size) * size)
+        , move(static_cast<std::size_t>(size) * size)
+        , seen(static_cast<std::size_t>(size) * size, 0)
+        , closed(static_cast<std::size_t>(size) * size, 0)
+        , generation{ 0 }, heap{}
+    {
+    }
 
-        return false;
+    /*!*****************************************************************************
+     * @brief Invalidates the results of the previous query.
+    *******************************************************************************/
+    void GridDijkstras::nextGeneration()
+    {
+        // Stamps left over from the previous wrap would look current again
+        if (++generation == 0)
+        {
+            std::fill(seen.begin(), seen.end(), 0u);
+            std::fill(closed.begin(), closed.end(), 0u);
+            generation = 1;
+        }
     }
 
+    /*!*****************************************************************************
+     * @brief Runs Dijkstra's algorithm to find the path from the starting position to the target position.
+     *
+     * @param starting
+     *     An array of 2 elements [j, i] representing the starting position on the map.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+     *
+     * @return
+     *     A vector of characters representing the path from the starting position to the target position.
+    *******************************************************************************/
+    std::vector<char> GridDijkstras::run(Key starting, Key target)
+    {
+        std::vector<char> path{};
+        run(starting, target, path);
+        return path;
+    }
+
+    /*!*****************************************************************************
+     * @brief Runs Dijkstra's algorithm and writes the path into a reused vector.
+     *
+     * @param starting
+     *     An array of 2 elements [j, i] representing the starting position on the map.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+     *
+     * @param path
+     *     Receives the moves; left empty if the target cannot be reached.
+    *******************************************************************************/
+    void GridDijkstras::run(Key starting, Key target, std::vector<char>& path)
+    {
+        path.clear();
+        auto inside = [this](const Key& key)
+        {
+            return key[0] >= 0 && key[0] < size && key[1] >= 0 && key[1] < size;
+        };
+        if (!inside(starting) || !inside(target))
+            return;
+
+        nextGeneration();
+        heap.clear();
+
+        const int start = starting[0] * size + starting[1];
+        const int goal = target[0] * size + target[1];
+
+        auto relax = [this](int cell, int cost, char m)
+        {
+            if (map[cell] != 0 || closed[cell] == generation
+                || (seen[cell] == generation && g[cell] <= cost))
+                return;
+            seen[cell] = generation;
+            g[cell] = cost;
+            move[cell] = m;
+            heap.emplace_back(cost, cell);
+            std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int>>{});
+        };
+
+        seen[start] = generation;
+        g[start] = 0;
+        heap.emplace_back(0, start);
+
+        while (!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int>>{});
+            int cost = heap.back().first;
+            int cell = heap.back().second;
+            heap.pop_back();
+
+            if (closed[cell] == generation)
+                continue;
+            closed[cell] = generation;
+
+            if (cell == goal)
+            {
+                // Walk back along the moves, each one names the step into a cell
+                while (cell != start)
+                {
+                    char m = move[cell];
+                    path.push_back(m);
+                    cell -= (m == 'W') ? -1 : (m == 'E') ? 1 : (m == 'N') ? -size : size;
+                }
+                std::reverse(path.begin(), path.end());
+                return;
+            }
+
+            // Same move order as GetMapAdjacents
+            int j = cell / size;
+            int i = cell % size;
+            if (i > 0)
+                relax(cell - 1, cost + 10, 'W');
+            if (i < size - 1)
+                relax(cell + 1, cost + 10, 'E');
+            if (j > 0)
+                relax(cell - size, cost + 10, 'N');
+            if (j < size - 1)
+                relax(cell + size, cost + 10, 'S');
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Constructs a FlowField object without a target.
+     *
+     * @param map
+     *     A pointer to an array of integers representing the map.
+     *
+     * @param size
+     *     The width and height of the map in terms of the number of elements.
+    *******************************************************************************/
+    FlowField::FlowField(const int* map, int size)
+        : map{ map }, size{ size }
+        , distance(static_cast<std::size_t>(size) * size, -1)
+        , direction(static_cast<std::size_t>(size) * size, 0)
+        , queue{}, target{ -1 }, dirty{ false }
+    {
+        queue.reserve(static_cast<std::size_t>(size) * size);
+    }
+
+    /*!*****************************************************************************
+     * @brief Sets the target; the field is rebuilt by the next update if it moved.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+    *******************************************************************************/
+    void FlowField::setTarget(Key target)
+    {
+        int cell = cellOf(target);
+        if (cell != this->target)
+        {
+            this->target = cell;
+            dirty = true;
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Marks the field as stale after cells of the map were changed.
+    *******************************************************************************/
+    void FlowField::mapChanged()
+    {
+        dirty = true;
+    }
+
+    /*!*****************************************************************************
+     * @brief Rebuilds the field if the target or the map changed since the last build.
+     *
+     * @return
+     *     True if the field was rebuilt.
+    *******************************************************************************/
+    bool FlowField::update()
+    {
+        if (!dirty)
+            return false;
+        dirty = false;
+
+        std::fill(distance.begin(), distance.end(), -1);
+        std::fill(direction.begin(), direction.end(), 0);
+        if (target < 0)
+            return true;
+
+        // Every move costs the same, so a breadth first search from the target
+        // reaches the cells in order of distance. A cell points back at the
+        // cell it was reached from.
+        queue.clear();
+        queue.push_back(target);
+        distance[target] = 0;
+
+        auto reach = [this](int cell, int from, char move)
+        {
+            if (map[cell] != 0 || distance[cell] >= 0)
+                return;
+            distance[cell] = distance[from] + 10;
+            direction[cell] = move;
+            queue.push_back(cell);
+        };
+
+        for (std::size_t k = 0; k < queue.size(); ++k)
+        {
+            int cell = queue[k];
+            int j = cell / size;
+            int i = cell % size;
+            if (i > 0)
+                reach(cell - 1, cell, 'E');
+            if (i < size - 1)
+                reach(cell + 1, cell, 'W');
+            if (j > 0)
+                reach(cell - size, cell, 'S');
+            if (j < size - 1)
+                reach(cell + size, cell, 'N');
+        }
+        return true;
+    }
+
+    /*!*****************************************************************************
+     * @brief Returns the next move from a cell towards the target.
+     *
+     * @param key
+     *     An array of 2 elements [j, i] representing the position of the agent.
+     *
+     * @return
+     *     'W', 'E', 'N' or 'S', or 0 at the target and where it cannot be reached.
+    *******************************************************************************/
+    char FlowField::next(Key key) const
+    {
+        int cell = cellOf(key);
+        return cell < 0 ? 0 : direction[cell];
+    }
+
+    /*!*****************************************************************************
+     * @brief Returns the cost from a cell to the target.
+     *
+     * @param key
+     *     An array of 2 elements [j, i] representing the position of the agent.
+     *
+     * @return
+     *     The cost of the path, or -1 if the target cannot be reached.
+    *******************************************************************************/
+    int FlowField::getDistance(Key key) const
+    {
+        int cell = cellOf(key);
+        return cell < 0 ? -1 : distance[cell];
+    }
+
+    /*!*****************************************************************************
+     * @brief Follows the field from a cell to the target.
+     *
+     * @param key
+     *     An array of 2 elements [j, i] representing the position of the agent.
+     *
+     * @return
+     *     A vector of characters representing the path to the target.
+    *******************************************************************************/
+    std::vector<char> FlowField::getPath(Key key) const
+    {
+        std::vector<char> path{};
+        int cell = cellOf(key);
+        if (cell < 0)
+            return path;
+
+        for (char move = direction[cell]; move != 0; move = direction[cell])
+        {
+            path.push_back(move);
+            cell += (move == 'W') ? -1 : (move == 'E') ? 1 : (move == 'N') ? -size : size;
+        }
+        return path;
+    }
+
+    /*!*****************************************************************************
+     * @brief Constructs an HPAStar object and builds the clusters.
+     *
+     * @param map
+     *     A pointer to an array of integers representing the map.
+     *
+     * @param size
+     *     The width and height of the map in terms of the number of elements.
+     *
+     * @param clusterSize
+     *     The width and height of a cluster in terms of the number of elements.
+    *******************************************************************************/
+    HPAStar::HPAStar(const int* map, int size, int clusterSize)
+        : map{ map }, size{ size }, clusterSize{ clusterSize }
+        , clusters{ size > 0 ? (size + clusterSize - 1) / clusterSize : 0 }
+        , clusterList(static_cast<std::size_t>(clusters) * clusters)
+        , east(clusterList.size()), south(clusterList.size())
+        , distance(static_cast<std::size_t>(clusterSize) * clusterSize)
+        , move(static_cast<std::size_t>(clusterSize) * clusterSize)
+        , seen(static_cast<std::size_t>(clusterSize) * clusterSize, 0)
+        , queue{}, generation{ 0 }, explored{ -1 }
+        , openlist{}, closedlist{}, expanded{ 0 }
+    {
+        queue.reserve(distance.size());
+        for (int k = 0; k < static_cast<int>(clusterList.size()); ++k)
+            findEntrances(k);
+        for (int k = 0; k < static_cast<int>(clusterList.size()); ++k)
+            buildCluster(k);
+    }
+
+    /*!*****************************************************************************
+     * @brief Returns the number of entrances in all clusters.
+    *******************************************************************************/
+    std::size_t HPAStar::getNodeCount() const
+    {
+        std::size_t count = 0;
+        for (const Cluster& cluster : clusterList)
+            count += cluster.nodes.size();
+        return count;
+    }
+
+    /*!*****************************************************************************
+     * @brief Returns the position of a cell in the nodes of a cluster, or -1.
+     *
+     * @param cluster
+     *     The cluster that holds the cell.
+     *
+     * @param cell
+     *     The cell as j * size + i.
+    *******************************************************************************/
+    int HPAStar::indexOf(int cluster, int cell) const
+    {
+        const std::vector<int>& nodes = clusterList[cluster].nodes;
+        auto it = std::lower_bound(nodes.begin(), nodes.end(), cell);
+        return (it != nodes.end() && *it == cell) ? static_cast<int>(it - nodes.begin()) : -1;
+    }
+
+    /*!*****************************************************************************
+     * @brief Finds the entrances on the right and the bottom border of a cluster.
+     *
+     * @param cluster
+     *     The cluster that owns the two borders.
+    *******************************************************************************/
+    void HPAStar::findEntrances(int cluster)
+    {
+        const int cj = cluster / clusters;
+        const int ci = cluster % clusters;
+        const int j0 = cj * clusterSize;
+        const int i0 = ci * clusterSize;
+
+        // Short runs of open cells get an entrance in the middle, long runs
+        // one at each end, as in the original HPA*
+        auto scan = [this](std::vector<Transition>& transitions, int first, int length, int step, int across)
+        {
+            int run = 0;
+            for (int t = 0; t <= length; ++t)
+            {
+                int cell = first + t * step;
+                if (t < length && map[cell] == 0 && map[cell + across] == 0)
+                {
+                    ++run;
+                    continue;
+                }
+                if (run > 0)
+                {
+                    int end = first + (t - 1) * step;
+                    int begin = end - (run - 1) * step;
+                    if (run < 6)
+                    {
+                        int middle = begin + (run / 2) * step;
+                        transitions.push_back(Transition{ middle, middle + across });
+                    }
+                    else
+                    {
+                        transitions.push_back(Transition{ begin, begin + across });
+                        transitions.push_back(Transition{ end, end + across });
+                    }
+                }
+                run = 0;
+            }
+        };
+
+        // Last column of this cluster against the first of the next one, cut
+        // short where the map ends
+        east[cluster].clear();
+        if (ci + 1 < clusters)
+            scan(east[cluster], j0 * size + i0 + clusterSize - 1,
+                std::min(clusterSize, size - j0), size, 1);
+
+        south[cluster].clear();
+        if (cj + 1 < clusters)
+            scan(south[cluster], (j0 + clusterSize - 1) * size + i0,
+                std::min(clusterSize, size - i0), 1, size);
+    }
+
+    /*!*****************************************************************************
+     * @brief Collects the entrances of a cluster and the costs between them.
+     *
+     * @param cluster
+     *     The cluster to build.
+    *******************************************************************************/
+    void HPAStar::buildCluster(int cluster)
+    {
+        Cluster& c = clusterList[cluster];
+        c.nodes.clear();
+
+        for (const Transition& t : east[cluster])
+            c.nodes.push_back(t.inside);
+        for (const Transition& t : south[cluster])
+            c.nodes.push_back(t.inside);
+        if (cluster % clusters > 0)
+            for (const Transition& t : east[cluster - 1])
+                c.nodes.push_back(t.across);
+        if (cluster / clusters > 0)
+            for (const Transition& t : south[cluster - clusters])
+                c.nodes.push_back(t.across);
+
+        std::sort(c.nodes.begin(), c.nodes.end());
+        c.nodes.erase(std::unique(c.nodes.begin(), c.nodes.end()), c.nodes.end());
+
+        const std::size_t n = c.nodes.size();
+        c.costs.assign(n * n, -1);
+        for (std::size_t a = 0; a < n; ++a)
+        {
+            explore(c.nodes[a]);
+            for (std::size_t b = 0; b < n; ++b)
+                c.costs[a * n + b] = distanceTo(c.nodes[b]);
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Searches breadth first from a cell without leaving its cluster.
+     *
+     * @param from
+     *     The cell to start from.
+    *******************************************************************************/
+    void HPAStar::explore(int from)
+    {
+        // Stamps left over from the previous wrap would look current again
+        if (++generation == 0)
+        {
+            std::fill(seen.begin(), seen.end(), 0u);
+            generation = 1;
+        }
+
+        explored = clusterOf(from);
+        const int j0 = explored / clusters * clusterSize;
+        const int i0 = explored % clusters * clusterSize;
+        const int j1 = std::min(j0 + clusterSize, size);
+        const int i1 = std::min(i0 + clusterSize, size);
+
+        auto local = [this, j0, i0](int cell)
+        {
+            return (cell / size - j0) * clusterSize + (cell % size - i0);
+        };
+
+        queue.clear();
+        queue.push_back(from);
+        seen[local(from)] = generation;
+        distance[local(from)] = 0;
+        move[local(from)] = 0;
+
+        for (std::size_t k = 0; k < queue.size(); ++k)
+        {
+            int cell = queue[k];
+            int j = cell / size;
+            int i = cell % size;
+            int d = distance[local(cell)] + 10;
+
+            auto reach = [&](int next, char m)
+            {
+                if (map[next] != 0 || seen[local(next)] == generation)
+                    return;
+                seen[local(next)] = generation;
+                distance[local(next)] = d;
+                move[local(next)] = m;
+                queue.push_back(next);
+            };
+
+            // Same move order as GetMapAdjacents
+            if (i > i0)
+                reach(cell - 1, 'W');
+            if (i < i1 - 1)
+                reach(cell + 1, 'E');
+            if (j > j0)
+                reach(cell - size, 'N');
+            if (j < j1 - 1)
+                reach(cell + size, 'S');
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Cost from the cell of the last explore to a cell of the same cluster.
+     *
+     * @param cell
+     *     The cell as j * size + i.
+     *
+     * @return
+     *     The cost, or -1 if the cell was not reached.
+    *******************************************************************************/
+    int HPAStar::distanceTo(int cell) const
+    {
+        if (clusterOf(cell) != explored)
+            return -1;
+        int l = (cell / size - explored / clusters * clusterSize) * clusterSize
+            + (cell % size - explored % clusters * clusterSize);
+        return seen[l] == generation ? distance[l] : -1;
+    }
+
+    /*!*****************************************************************************
+     * @brief Appends the moves from the cell of the last explore to another cell.
+     *
+     * @param to
+     *     A cell reached by the last explore.
+     *
+     * @param path
+     *     Receives the moves.
+    *******************************************************************************/
+    void HPAStar::appendMoves(int to, std::vector<char>& path)
+    {
+        const int j0 = explored / clusters * clusterSize;
+        const int i0 = explored % clusters * clusterSize;
+        std::size_t begin = path.size();
+
+        // Each move names the step into a cell, so walk back and flip them
+        for (int cell = to;;)
+        {
+            char m = move[(cell / size - j0) * clusterSize + (cell % size - i0)];
+            if (m == 0)
+                break;
+            path.push_back(m);
+            cell -= (m == 'W') ? -1 : (m == 'E') ? 1 : (m == 'N') ? -size : size;
+        }
+        std::reverse(path.begin() + begin, path.end());
+    }
+
+    /*!*****************************************************************************
+     * @brief Finds a path through the entrances and refines it into moves.
+     *
+     * @param starting
+     *     An array of 2 elements [j, i] representing the starting position on the map.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+     *
+     * @return
+     *     A vector of characters representing the path from the starting position to the target position.
+    *******************************************************************************/
+    std::vector<char> HPAStar::run(Key starting, Key target)
+    {
+        std::vector<char> path{};
+        expanded = 0;
+
+        auto inside = [this](const Key& key)
+        {
+            return key[0] >= 0 && key[0] < size && key[1] >= 0 && key[1] < size;
+        };
+        if (!inside(starting) || !inside(target))
+            return path;
+
+        const int start = starting[0] * size + starting[1];
+        const int goal = target[0] * size + target[1];
+        if (start == goal || map[start] != 0 || map[goal] != 0)
+            return path;
+
+        // Link the start and the target to the entrances of their clusters
+        const int cs = clusterOf(start);
+        const int ct = clusterOf(goal);
+        std::vector<int> startCosts;
+        std::vector<int> targetCosts;
+        int direct = -1;
+
+        explore(goal);
+        for (int node : clusterList[ct].nodes)
+            targetCosts.push_back(distanceTo(node));
+        explore(start);
+        for (int node : clusterList[cs].nodes)
+            startCosts.push_back(distanceTo(node));
+        direct = distanceTo(goal);
+
+        auto h = [this, goal](int cell)
+        {
+            return 10 * (std::abs(cell / size - goal / size) + std::abs(cell % size - goal % size));
+        };
+        auto keyOf = [this](int cell)
+        {
+            return GridKey{ cell / size, cell % size };
+        };
+
+        AbstractNode* pCurrent = nullptr;
+        auto relax = [&](int cell, int cost)
+        {
+            GridKey key = keyOf(cell);
+            if (closedlist.find(key))
+                return;
+            int tentative_g = pCurrent->g + cost;
+            AbstractNode* openlist_found = openlist.find(key);
+            if (!openlist_found)
+                openlist.push(new AbstractNode(key, tentative_g, 0, pCurrent),
+                    tentative_g + h(cell), -tentative_g);
+            else if (tentative_g < openlist_found->g)
+            {
+                openlist_found->parent = pCurrent;
+                openlist_found->g = tentative_g;
+                openlist.decrease(openlist_found, tentative_g + h(cell), -tentative_g);
+            }
+        };
+
+        // A* over the entrances, with the start and the target as extra nodes
+        openlist.push(new AbstractNode(keyOf(start)), h(start));
+        while (!openlist.empty())
+        {
+            pCurrent = openlist.pop();
+            closedlist.add(pCurrent->key, pCurrent);
+
+            int cell = pCurrent->key[0] * size + pCurrent->key[1];
+            if (cell == goal)
+                break;
+            ++expanded;
+
+            int k = clusterOf(cell);
+            const Cluster& cluster = clusterList[k];
+            const int n = static_cast<int>(cluster.nodes.size());
+            int local = indexOf(k, cell);
+
+            if (k == ct)
+            {
+                int cost = (cell == start) ? direct : (local >= 0 ? targetCosts[local] : -1);
+                if (cost >= 0)
+                    relax(goal, cost);
+            }
+
+            if (local < 0)
+            {
+                // Only the start is expanded without being an entrance
+                for (int m = 0; m < n; ++m)
+                    if (startCosts[m] >= 0)
+                        relax(cluster.nodes[m], startCosts[m]);
+            }
+            else
+            {
+                for (int m = 0; m < n; ++m)
+                    if (m != local && cluster.costs[local * n + m] >= 0)
+                        relax(cluster.nodes[m], cluster.costs[local * n + m]);
+
+                // Entrances of the neighboring clusters right across the border
+                int j = cell / size;
+                int i = cell % size;
+                const int across[4] = {
+                    i > 0 ? cell - 1 : -1,
+                    i < size - 1 ? cell + 1 : -1,
+                    j > 0 ? cell - size : -1,
+                    j < size - 1 ? cell + size : -1
+                };
+                for (int next : across)
+                    if (next >= 0 && clusterOf(next) != k && indexOf(clusterOf(next), next) >= 0)
+                        relax(next, 10);
+            }
+            pCurrent = nullptr;
+        }
+
+        if (pCurrent)
+        {
+            // Refine every abstract step with a search inside its cluster
+            std::vector<int> waypoints;
+            for (const AbstractNode* pNode = pCurrent; pNode; pNode = pNode->parent)
+                waypoints.push_back(pNode->key[0] * size + pNode->key[1]);
+            std::reverse(waypoints.begin(), waypoints.end());
+
+            for (std::size_t w = 1; w < waypoints.size(); ++w)
+            {
+                int a = waypoints[w - 1];
+                int b = waypoints[w];
+                if (clusterOf(a) != clusterOf(b))
+                    path.push_back(b == a - 1 ? 'W' : b == a + 1 ? 'E' : b == a - size ? 'N' : 'S');
+                else
+                {
+                    explore(a);
+                    appendMoves(b, path);
+                }
+            }
+        }
+
+        // Free the nodes but keep the memory of both lists for the next run
+        openlist.clear();
+        closedlist.clear();
+        return path;
+    }
+
+    /*!*****************************************************************************
+     * @brief Rebuilds the clusters affected by edited cells.
+     *
+     * @param cells
+     *     The positions [j, i] of the cells that were changed on the map.
+    *******************************************************************************/
+    void HPAStar::mapChanged(const std::vector<Key>& cells)
+    {
+        std::vector<int> owners;
+        std::vector<int> rebuild;
+
+        for (const Key& key : cells)
+        {
+            if (key[0] < 0 || key[0] >= size || key[1] < 0 || key[1] >= size)
+                continue;
+            int k = clusterOf(key[0] * size + key[1]);
+            rebuild.push_back(k);
+
+            // A cell on the first row or column lies on a border owned by the
+            // cluster above or on the left
+            owners.push_back(k);
+            if (key[1] % clusterSize == 0 && k % clusters > 0)
+                owners.push_back(k - 1);
+            if (key[0] % clusterSize == 0 && k / clusters > 0)
+                owners.push_back(k - clusters);
+        }
+
+        std::sort(owners.begin(), owners.end());
+        owners.erase(std::unique(owners.begin(), owners.end()), owners.end());
+        for (int k : owners)
+        {
+            std::vector<Transition> oldEast = east[k];
+            std::vector<Transition> oldSouth = south[k];
+            findEntrances(k);
+
+            // Clusters on both sides of a border share its entrances
+            if (east[k] != oldEast)
+            {
+                rebuild.push_back(k);
+                rebuild.push_back(k + 1);
+            }
+            if (south[k] != oldSouth)
+            {
+                rebuild.push_back(k);
+                rebuild.push_back(k + clusters);
+            }
+        }
+
+        std::sort(rebuild.begin(), rebuild.end());
+        rebuild.erase(std::unique(rebuild.begin(), rebuild.end()), rebuild.end());
+        for (int k : rebuild)
+            buildCluster(k);
+    }
+
+    /*!*****************************************************************************
+     * @brief Constructs a JumpPointSearch object.
+     *
+     * @param map
+     *     A pointer to an array of integers representing the map.
+     *
+     * @param size
+     *     The width and height of the map in terms of the number of elements.
+     *
+     * @param diagonal
+     *     Allows the 4 diagonal moves in addition to W, E, N and S.
+    *******************************************************************************/
+    JumpPointSearch::JumpPointSearch(const int* map, int size, bool diagonal)
+        : map{ map }, size{ size }, diagonal{ diagonal }
+        , g(static_cast<std::size_t>(size) * size)
+        , parent(static_cast<std::size_t>(size) * size)
+        , seen(static_cast<std::size_t>(size) * size, 0)
+        , closed(static_cast<std::size_t>(size) * size, 0)
+        , generation{ 0 }, heap{}, goal{ -1 }, cost{ -1 }, expanded{ 0 }
+    {
+    }
+
+    /*!*****************************************************************************
+     * @brief Invalidates the results of the previous query.
+    *******************************************************************************/
+    void JumpPointSearch::nextGeneration()
+    {
+        // Stamps left over from the previous wrap would look current again
+        if (++generation == 0)
+        {
+            std::fill(seen.begin(), seen.end(), 0u);
+            std::fill(closed.begin(), closed.end(), 0u);
+            generation = 1;
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Lower bound of the cost from a cell to the goal.
+     *
+     * @param cell
+     *     The cell as j * size + i.
+     *
+     * @return
+     *     Manhattan distance without diagonal moves, octile distance with them.
+    *******************************************************************************/
+    int JumpPointSearch::heuristic(int cell) const
+    {
+        int dj = std::abs(cell / size - goal / size);
+        int di = std::abs(cell % size - goal % size);
+        if (!diagonal)
+            return 10 * (dj + di);
+        return 10 * std::max(dj, di) + 4 * std::min(dj, di);
+    }
+
+    /*!*****************************************************************************
+     * @brief Scans from a cell in one direction for the next jump point.
+     *
+     * @param j
+     *     Row of the first cell of the scan.
+     *
+     * @param i
+     *     Column of the first cell of the scan.
+     *
+     * @param dj
+     *     Vertical direction of the scan, -1, 0 or 1.
+     *
+     * @param di
+     *     Horizontal direction of the scan, -1, 0 or 1.
+     *
+     * @return
+     *     The jump point as j * size + i, or -1 if the scan hits an obstacle.
+    *******************************************************************************/
+    int JumpPointSearch::jump(int j, int i, int dj, int di) const
+    {
+        while (walkable(j, i))
+        {
+            int cell = j * size + i;
+            if (cell == goal)
+                return cell;
+
+            if (dj != 0 && di != 0)
+            {
+                // A diagonal stops where one of its straight scans finds something
+                if (jump(j, i + di, 0, di) >= 0 || jump(j + dj, i, dj, 0) >= 0)
+                    return cell;
+                // Corners are never cut
+                if (!walkable(j, i + di) || !walkable(j + dj, i))
+                    return -1;
+            }
+            else if (di != 0)
+            {
+                // A side opens up just past an obstacle
+                if ((walkable(j - 1, i) && !walkable(j - 1, i - di))
+                    || (walkable(j + 1, i) && !walkable(j + 1, i - di)))
+                    return cell;
+            }
+            else
+            {
+                if ((walkable(j, i - 1) && !walkable(j - dj, i - 1))
+                    || (walkable(j, i + 1) && !walkable(j - dj, i + 1)))
+                    return cell;
+                // Without diagonals the vertical scan plays their part
+                if (!diagonal && (jump(j, i - 1, 0, -1) >= 0 || jump(j, i + 1, 0, 1) >= 0))
+                    return cell;
+            }
+
+            j += dj;
+            i += di;
+        }
+        return -1;
+    }
+
+    /*!*****************************************************************************
+     * @brief Runs Jump Point Search to find the path from the starting position to the target position.
+     *
+     * @param starting
+     *     An array of 2 elements [j, i] representing the starting position on the map.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+     *
+     * @return
+     *     A vector of characters representing the path from the starting position to the target position.
+    *******************************************************************************/
+    std::vector<char> JumpPointSearch::run(Key starting, Key target)
+    {
+        std::vector<char> path{};
+        run(starting, target, path);
+        return path;
+    }
+
+    /*!*****************************************************************************
+     * @brief Runs Jump Point Search and writes the path into a reused vector.
+     *
+     * @param starting
+     *     An array of 2 elements [j, i] representing the starting position on the map.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+     *
+     * @param path
+     *     Receives the moves; left empty if the target cannot be reached.
+    *******************************************************************************/
+    void JumpPointSearch::run(Key starting, Key target, std::vector<char>& path)
+    {
+        path.clear();
+        cost = -1;
+        expanded = 0;
+        auto inside = [this](const Key& key)
+        {
+            return key[0] >= 0 && key[0] < size && key[1] >= 0 && key[1] < size;
+        };
+        if (!inside(starting) || !inside(target))
+            return;
+
+        nextGeneration();
+        heap.clear();
+
+        const int start = starting[0] * size + starting[1];
+        goal = target[0] * size + target[1];
+
+        seen[start] = generation;
+        g[start] = 0;
+        parent[start] = start;
+        heap.emplace_back(heuristic(start), start);
+
+        const int DIRECTIONS[8][2] = {
+            { 0, -1 }, { 0, 1 }, { -1, 0 }, { 1, 0 },
+            { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 }
+        };
+        const int count = diagonal ? 8 : 4;
+        auto sign = [](int v) { return (v > 0) - (v < 0); };
+
+        while (!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int>>{});
+            int cell = heap.back().second;
+            heap.pop_back();
+
+            if (closed[cell] == generation)
+                continue;
+            closed[cell] = generation;
+
+            if (cell == goal)
+                break;
+            ++expanded;
+
+            int j = cell / size;
+            int i = cell % size;
+            int pj = sign(j - parent[cell] / size);
+            int pi = sign(i - parent[cell] % size);
+
+            for (int d = 0; d < count; ++d)
+            {
+                int dj = DIRECTIONS[d][0];
+                int di = DIRECTIONS[d][1];
+
+                // Keep only the moves that are not reached as cheaply through
+                // the parent; the start keeps all of them
+                if ((pj != 0 && dj != 0 && dj != pj) || (pi != 0 && di != 0 && di != pi))
+                    continue;
+                if (dj != 0 && di != 0 && (!walkable(j, i + di) || !walkable(j + dj, i)))
+                    continue;
+
+                int next = jump(j + dj, i + di, dj, di);
+                if (next < 0 || closed[next] == generation)
+                    continue;
+
+                int steps = std::max(std::abs(next / size - j), std::abs(next % size - i));
+                int tentative_g = g[cell] + steps * (dj != 0 && di != 0 ? 14 : 10);
+                if (seen[next] == generation && g[next] <= tentative_g)
+                    continue;
+
+                seen[next] = generation;
+                g[next] = tentative_g;
+                parent[next] = cell;
+                heap.emplace_back(tentative_g + heuristic(next), next);
+                std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int>>{});
+            }
+        }
+
+        if (closed[goal] != generation)
+            return;
+        cost = g[goal];
+
+        // Walk back over the jump points, the moves come out reversed
+        for (int cell = goal; cell != start; cell = parent[cell])
+        {
+            int dj = sign(cell / size - parent[cell] / size);
+            int di = sign(cell % size - parent[cell] % size);
+            int steps = std::max(std::abs(cell / size - parent[cell] / size),
+                std::abs(cell % size - parent[cell] % size));
+            for (int k = 0; k < steps; ++k)
+            {
+                if (di != 0)
+                    path.push_back(di < 0 ? 'W' : 'E');
+                if (dj != 0)
+                    path.push_back(dj < 0 ? 'N' : 'S');
+            }
+        }
+        std::reverse(path.begin(), path.end());
+    }
+
+    /*!*****************************************************************************
+     * @brief Manhattan distance between two grid keys.
+     *
+     * @param a
+     *     The first key [j, i].
+     *
+     * @param b
+     *     The second key [j, i].
+     *
+     * @return
+     *     Cost of the straight moves from a to b.
+    *******************************************************************************/
+    int Manhattan::operator()(const Key& a, const Key& b) const
+    {
+        return cost * (std::abs(a[0] - b[0]) + std::abs(a[1] - b[1]));
+    }
+
+    /*!*****************************************************************************
+     * @brief Octile distance between two grid keys.
+     *
+     * @param a
+     *     The first key [j, i].
+     *
+     * @param b
+     *     The second key [j, i].
+     *
+     * @return
+     *     Cost of the diagonal and straight moves from a to b.
+    *******************************************************************************/
+    int Octile::operator()(const Key& a, const Key& b) const
+    {
+        int dj = std::abs(a[0] - b[0]);
+        int di = std::abs(a[1] - b[1]);
+        return cost * std::max(dj, di) + (cost * 4 / 10) * std::min(dj, di);
+    }
+
+    /*!*****************************************************************************
+     * @brief Euclidean distance between two grid keys.
+     *
+     * @param a
+     *     The first key [j, i].
+     *
+     * @param b
+     *     The second key [j, i].
+     *
+     * @return
+     *     Cost of the straight line from a to b, rounded down.
+    *******************************************************************************/
+    int Euclidean::operator()(const Key& a, const Key& b) const
+    {
+        double dj = a[0] - b[0];
+        double di = a[1] - b[1];
+        return static_cast<int>(cost * std::sqrt(dj * dj + di * di));
+    }
+
+    /*!*****************************************************************************
+     * @brief Runs A* to find the path from the starting position to the target position.
+     *
+     * @param starting
+     *     An array of 2 elements [j, i] representing the starting position on the map.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+     *
+     * @return
+     *     A vector of characters representing the path from the starting position to the target position.
+    *******************************************************************************/
+    template<typename H>
+    std::vector<char> AStar<H>::run(Key starting, Key target)
+    {
+        Node* pCurrent = nullptr;
+        expanded = 0;
+
+        openlist.push(new Node(starting), heuristic(starting, target));
+
+        while (!openlist.empty())
+        {
+            pCurrent = openlist.pop();
+            closedlist.add(pCurrent->key, pCurrent);
+
+            if (pCurrent->key == target)
+                break;
+
+            ++expanded;
+            std::vector<Node*> adjacents = this->pGetAdjacents->operator()(pCurrent->key);
+            for (Node* adjacent : adjacents)
+            {
+                if (!closedlist.find(adjacent->key))
+                {
+                    int tentative_g = pCurrent->g + adjacent->g;
+                    Node* openlist_found = openlist.find(adjacent->key);
+                    if (!openlist_found)
+                        openlist.push(new Node(adjacent->key,
+                            tentative_g,
+                            adjacent->info,
+                            pCurrent), tentative_g + heuristic(adjacent->key, target), -tentative_g);
+                    else if (tentative_g < openlist_found->g)
+                    {
+                        openlist_found->parent = pCurrent;
+                        openlist_found->info = adjacent->info;
+                        openlist_found->g = tentative_g;
+                        openlist.decrease(openlist_found,
+                            tentative_g + heuristic(adjacent->key, target), -tentative_g);
+                    }
+                }
+                delete adjacent;
+            }
+            pCurrent = nullptr;
+        }
+
+        auto path = tracePath(pCurrent);
+
+        // Free the nodes but keep the memory of both lists for the next run
+        openlist.clear();
+        closedlist.clear();
+        return path;
+    }
+
+    template class AStar<Manhattan>;
+    template class AStar<Octile>;
+    template class AStar<Euclidean>;
+
+    /*!*****************************************************************************
+     * @brief Cheapest cost to the target through the successors of a key.
+     *
+     * @param key
+     *     The key whose successors are checked.
+     *
+     * @return
+     *     The lowest edge cost plus successor cost, or infinity.
+    *******************************************************************************/
+    template<typename H>
+    int DStarLite<H>::bestSuccessor(const Key& key)
+    {
+        int best = INF;
+        std::vector<Node*> adjacents = this->pGetAdjacents->operator()(key);
+        for (Node* adjacent : adjacents)
+        {
+            best = std::min(best, add(adjacent->g, get(adjacent->key).g));
+            delete adjacent;
+        }
+        return best;
+    }
+
+    /*!*****************************************************************************
+     * @brief Queues, requeues or dequeues a key depending on whether it is consistent.
+     *
+     * @param key
+     *     The key whose costs may have changed.
+    *******************************************************************************/
+    template<typename H>
+    void DStarLite<H>::updateVertex(const Key& key)
+    {
+        State state = get(key);
+        Node* queued = openlist.find(key);
+        if (state.g != state.rhs)
+        {
+            int k2 = std::min(state.g, state.rhs);
+            int k1 = k2 + heuristic(start, key) + km;
+            if (queued)
+                openlist.update(queued, k1, k2);
+            else
+                openlist.push(new Node(key, k2), k1, k2);
+        }
+        else if (queued)
+        {
+            openlist.erase(queued);
+            delete queued;
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Expands inconsistent nodes until the cost of the start is known.
+    *******************************************************************************/
+    template<typename H>
+    void DStarLite<H>::computeShortestPath()
+    {
+        auto startKey = [this]()
+        {
+            State state = get(start);
+            int k2 = std::min(state.g, state.rhs);
+            return std::make_pair(add(k2, km), k2); // h(start, start) is 0
+        };
+
+        while (!openlist.empty())
+        {
+            State s = get(start);
+            std::pair<int, int> top{ openlist.topPriority(), openlist.topTie() };
+            if (!(top < startKey()) && s.rhs <= s.g)
+                break;
+
+            Node* pCurrent = openlist.top();
+            Key u = pCurrent->key;
+            State state = get(u);
+            int k2 = std::min(state.g, state.rhs);
+            std::pair<int, int> fresh{ k2 + heuristic(start, u) + km, k2 };
+
+            // The agent moved since the node was queued
+            if (top < fresh)
+            {
+                openlist.update(pCurrent, fresh.first, fresh.second);
+                continue;
+            }
+
+            ++expanded;
+            openlist.erase(pCurrent);
+            delete pCurrent;
+
+            std::vector<Node*> predecessors = this->pGetAdjacents->reverse(u);
+            if (state.g > state.rhs)
+            {
+                // Overconsistent: the cost of u is final, pass it on
+                at(u).g = state.rhs;
+                for (Node* predecessor : predecessors)
+                {
+                    if (!(predecessor->key == goal))
+                    {
+                        State& previous = at(predecessor->key);
+                        previous.rhs = std::min(previous.rhs, add(predecessor->g, state.rhs));
+                        updateVertex(predecessor->key);
+                    }
+                    delete predecessor;
+                }
+            }
+            else
+            {
+                // Underconsistent: u got more expensive, so did whatever went through it
+                int old = state.g;
+                at(u).g = INF;
+                for (Node* predecessor : predecessors)
+                {
+                    Key p = predecessor->key;
+                    if (!(p == goal) && get(p).rhs == add(predecessor->g, old))
+                    {
+                        int rhs = bestSuccessor(p);
+                        at(p).rhs = rhs;
+                    }
+                    updateVertex(p);
+                    delete predecessor;
+                }
+                if (!(u == goal))
+                {
+                    int rhs = bestSuccessor(u);
+                    at(u).rhs = rhs;
+                }
+                updateVertex(u);
+            }
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Plans from the starting position, reusing the previous search if the target is the same.
+     *
+     * @param starting
+     *     An array of 2 elements [j, i] representing the current position of the agent.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+     *
+     * @return
+     *     A vector of characters representing the path from the starting position to the target position.
+    *******************************************************************************/
+    template<typename H>
+    std::vector<char> DStarLite<H>::run(Key starting, Key target)
+    {
+        expanded = 0;
+        if (!planned || !(target == goal))
+        {
+            // A new target starts a new search
+            openlist.clear();
+            states.clear();
+            km = 0;
+            start = starting;
+            goal = target;
+            at(goal).rhs = 0;
+            openlist.push(new Node(goal, 0), heuristic(start, goal), 0);
+            planned = true;
+        }
+        else
+        {
+            // Queued priorities were computed from the old start
+            km += heuristic(start, starting);
+            start = starting;
+        }
+
+        // Walk the path the way an agent would: take the move to the cheapest
+        // successor, then bring the search up to date for the new position.
+        // Only the first move from a start is guaranteed to be on a shortest
+        // path, and moving on costs nothing while no cells change.
+        std::vector<char> path{};
+        computeShortestPath();
+        while (!(start == goal) && path.size() <= states.size())
+        {
+            int best = INF;
+            Key next{};
+            char move = 0;
+            std::vector<Node*> adjacents = this->pGetAdjacents->operator()(start);
+            for (Node* adjacent : adjacents)
+            {
+                int cost = add(adjacent->g, get(adjacent->key).g);
+                if (cost < best)
+                {
+                    best = cost;
+                    next = adjacent->key;
+                    move = adjacent->info;
+                }
+                delete adjacent;
+            }
+            if (best >= INF)
+                break;
+
+            path.push_back(move);
+            km += heuristic(start, next);
+            start = next;
+            computeShortestPath();
+        }
+
+        // Later runs continue from the agent's real position
+        return (start == goal) ? path : std::vector<char>{};
+    }
+
+    /*!*****************************************************************************
+     * @brief Repairs the costs around cells whose edges changed; the next run replans.
+     *
+     * @param cells
+     *     The keys of the changed cells. Their reverse adjacents must include every
+     *     node whose edge into the cell was added, removed or changed in cost.
+    *******************************************************************************/
+    template<typename H>
+    void DStarLite<H>::mapChanged(const std::vector<Key>& cells)
+    {
+        if (!planned)
+            return;
+
+        // The old edge costs are gone, so take the minimum over all successors
+        // again. A cell that was just blocked has no predecessors any more, so
+        // its neighbours are found through its own moves as well.
+        for (const Key& cell : cells)
+        {
+            std::vector<Node*> predecessors = this->pGetAdjacents->reverse(cell);
+            std::vector<Node*> successors = this->pGetAdjacents->operator()(cell);
+            predecessors.insert(predecessors.end(), successors.begin(), successors.end());
+            predecessors.push_back(new Node(cell));
+            for (Node* predecessor : predecessors)
+            {
+                Key p = predecessor->key;
+                if (!(p == goal))
+                {
+                    int rhs = bestSuccessor(p);
+                    at(p).rhs = rhs;
+                }
+                updateVertex(p);
+                delete predecessor;
+            }
+        }
+    }
+
+    template class DStarLite<Manhattan>;
+    template class DStarLite<Octile>;
+    template class DStarLite<Euclidean>;
+
+    /*!*****************************************************************************
+     * @brief Drops the current query and sets up a new one without expanding anything.
+     *
+     * @param starting
+     *     An array of 2 elements [j, i] representing the starting position on the map.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+    *******************************************************************************/
+    template<typename H>
+    void SlicedSearch<H>::start(Key starting, Key target)
+    {
+        // Free the nodes of the last query but keep the memory of both lists
+        openlist.clear();
+        closedlist.clear();
+
+        this->target = target;
+        pFound = nullptr;
+        pBest = nullptr;
+        bestH = 0;
+        finished = false;
+        expanded = 0;
+
+        openlist.push(new Node(starting), heuristic(starting, target));
+    }
+
+    /*!*****************************************************************************
+     * @brief Expands at most maxExpansions nodes of the current query.
+     *
+     * @param maxExpansions
+     *     The budget of expansions for this slice.
+     *
+     * @return
+     *     `true` once the search is finished, found or not, `false` if it needs more steps.
+    *******************************************************************************/
+    template<typename H>
+    bool SlicedSearch<H>::step(std::size_t maxExpansions)
+    {
+        for (std::size_t n = 0; n < maxExpansions && !finished; ++n)
+            expand();
+        return finished;
+    }
+
+    /*!*****************************************************************************
+     * @brief Expands nodes of the current query until the deadline passes.
+     *
+     * @param deadline
+     *     The time by which the slice returns; at least one node is expanded.
+     *
+     * @return
+     *     `true` once the search is finished, found or not, `false` if it needs more steps.
+    *******************************************************************************/
+    template<typename H>
+    bool SlicedSearch<H>::step(Clock::time_point deadline)
+    {
+        // Reading the clock costs about as much as an expansion, so read it
+        // only every few expansions
+        do
+            step(CLOCK_STRIDE);
+        while (!finished && Clock::now() < deadline);
+        return finished;
+    }
+
+    /*!*****************************************************************************
+     * @brief Finds the path in a blocking mode.
+     *
+     * @param starting
+     *     An array of 2 elements [j, i] representing the starting position on the map.
+     *
+     * @param target
+     *     An array of 2 elements [j, i] representing the target position on the map.
+     *
+     * @return
+     *     A vector of characters representing the path from the starting position to the target position.
+    *******************************************************************************/
+    template<typename H>
+    std::vector<char> SlicedSearch<H>::run(Key starting, Key target)
+    {
+        start(starting, target);
+        while (!step(std::numeric_limits<std::size_t>::max())) {
+        }
+        return isFound() ? getPath() : std::vector<char>{};
+    }
+
+    /*!*****************************************************************************
+     * @brief Returns the path to the target, or the best partial path while it is not found.
+     *
+     * @return
+     *     A vector of characters representing the moves from the starting position.
+    *******************************************************************************/
+    template<typename H>
+    std::vector<char> SlicedSearch<H>::getPath() const
+    {
+        return tracePath(pFound ? pFound : pBest);
+    }
+
+    /*!*****************************************************************************
+     * @brief Closes the best open node and opens its adjacents.
+    *******************************************************************************/
+    template<typename H>
+    void SlicedSearch<H>::expand()
+    {
+        if (openlist.empty())
+        {
+            finished = true;
+            return;
+        }
+
+        Node* pCurrent = openlist.pop();
+        closedlist.add(pCurrent->key, pCurrent);
+
+        if (pCurrent->key == target)
+        {
+            pFound = pCurrent;
+            finished = true;
+            return;
+        }
+
+        // Closest to the target by the estimate, the farthest along on a tie
+        int h = heuristic(pCurrent->key, target);
+        if (!pBest || h < bestH || (h == bestH && pCurrent->g > pBest->g))
+        {
+            pBest = pCurrent;
+            bestH = h;
+        }
+
+        ++expanded;
+        std::vector<Node*> adjacents = this->pGetAdjacents->operator()(pCurrent->key);
+        for (Node* adjacent : adjacents)
+        {
+            if (!closedlist.find(adjacent->key))
+            {
+                int tentative_g = pCurrent->g + adjacent->g;
+                Node* openlist_found = openlist.find(adjacent->key);
+                if (!openlist_found)
+                    openlist.push(new Node(adjacent->key,
+                        tentative_g,
+                        adjacent->info,
+                        pCurrent), tentative_g + heuristic(adjacent->key, target), -tentative_g);
+                else if (tentative_g < openlist_found->g)
+                {
+                    openlist_found->parent = pCurrent;
+                    openlist_found->info = adjacent->info;
+                    openlist_found->g = tentative_g;
+                    openlist.decrease(openlist_found,
+                        tentative_g + heuristic(adjacent->key, target), -tentative_g);
+                }
+            }
+            delete adjacent;
+        }
+    }
+
+    template class SlicedSearch<Zero>;
+    template class SlicedSearch<Manhattan>;
+    template class SlicedSearch<Octile>;
+    template class SlicedSearch<Euclidean>;
+
+    /*!*****************************************************************************
+     * @brief Returns the states one move of the blank away.
+     *
+     * @param key
+     *     The tiles row by row, 0 for the blank.
+     *
+     * @return
+     *     A vector of pointers to AI::Node objects with the move of the blank as info.
+    *******************************************************************************/
+    std::vector<Node*> GetPuzzleAdjacents::operator()(Key key)
+    {
+        std::vector<Node> values;
+        adjacents(key, values);
+
+        std::vector<Node*> list;
+        for (const Node& value : values)
+            list.push_back(new Node(value));
+        return list;
+    }
+
+    /*!*****************************************************************************
+     * @brief Writes the states one move of the blank away without allocating nodes.
+     *
+     * @param key
+     *     The tiles row by row, 0 for the blank.
+     *
+     * @param list
+     *     The vector that receives the adjacent nodes, replacing its contents.
+    *******************************************************************************/
+    void GetPuzzleAdjacents::adjacents(Key key, std::vector<Node>& list)
+    {
+        list.clear();
+
+        const int n = static_cast<int>(key.size());
+        const int blank = static_cast<int>(std::find(key.begin(), key.end(), 0) - key.begin());
+        const int j = blank / width;
+        const int i = blank % width;
+
+        // The blank swaps places with the tile it moves onto
+        const int to[] = { blank - width, blank + width, blank - 1, blank + 1 };
+        const bool can[] = { j > 0, blank + width < n, i > 0, i < width - 1 };
+        const char move[] = { 'N', 'S', 'W', 'E' };
+
+        for (int d = 0; d < 4; ++d)
+        {
+            if (!can[d])
+                continue;
+            Key next = key;
+            next.set(blank, key[to[d]]);
+            next.set(to[d], 0);
+            list.emplace_back(next, 1, move[d]);
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Returns the states one move away with the move that leads back to the key.
+     *
+     * @param key
+     *     The tiles row by row, 0 for the blank.
+     *
+     * @return
+     *     A vector of pointers to AI::Node objects whose moves lead into the key.
+    *******************************************************************************/
+    std::vector<Node*> GetPuzzleAdjacents::reverse(Key key)
+    {
+        // Every move can be undone, only the move names flip
+        std::vector<Node*> list = operator()(key);
+        for (Node* node : list)
+            node->info = node->info == 'N' ? 'S' : node->info == 'S' ? 'N' : node->info == 'W' ? 'E' : 'W';
+        return list;
+    }
+
+    /*!*****************************************************************************
+     * @brief Returns whether one state can be reached from the other.
+     *
+     * @param from
+     *     The first state.
+     *
+     * @param to
+     *     The second state.
+     *
+     * @return
+     *     `true` if the states are in the same half of the permutations.
+    *******************************************************************************/
+    bool GetPuzzleAdjacents::solvable(const Key& from, const Key& to) const
+    {
+        // Every move swaps the blank with a tile, flipping the parity of the
+        // permutation, and moves the blank one row or one column. So the
+        // permutation parity plus the taxicab distance of the blank is even
+        // for any two states one move apart and so for any two connected ones.
+        auto parity = [this](const Key& key)
+        {
+            int inversions = 0;
+            for (std::size_t a = 0; a < key.size(); ++a)
+                for (std::size_t b = a + 1; b < key.size(); ++b)
+                    inversions += key[a] > key[b];
+            int blank = static_cast<int>(std::find(key.begin(), key.end(), 0) - key.begin());
+            return (inversions + blank / width + blank % width) % 2;
+        };
+        return parity(from) == parity(to);
+    }
+
+    /*!*****************************************************************************
+     * @brief Perfect hash of a state: its index among all permutations in lexicographic order.
+     *
+     * @param key
+     *     A permutation of 0..n-1 with n up to 16.
+     *
+     * @return
+     *     The Lehmer code of the key read as a factorial base number, below n!.
+    *******************************************************************************/
+    std::uint64_t GetPuzzleAdjacents::rank(const Key& key)
+    {
+        // Digit k counts the smaller elements still unused after position k,
+        // which is the element minus the smaller ones already used
+        const std::size_t n = key.size();
+        std::uint64_t index = 0;
+        std::uint32_t used = 0;
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            std::uint32_t below = used & ((1u << key[k]) - 1);
+            int smaller = 0;
+            for (; below; below &= below - 1)
+                ++smaller;
+            index = index * (n - k) + static_cast<std::uint64_t>(key[k] - smaller);
+            used |= 1u << key[k];
+        }
+        return index;
+    }
+
+    /*!*****************************************************************************
+     * @brief Inverse of rank().
+     *
+     * @param index
+     *     A rank below n!.
+     *
+     * @param n
+     *     The number of elements in the permutation.
+     *
+     * @return
+     *     The permutation of 0..n-1 with the given rank.
+    *******************************************************************************/
+    Key GetPuzzleAdjacents::unrank(std::uint64_t index, int n)
+    {
+        // Read the factorial base digits back, least significant last
+        int digits[Key::CAPACITY];
+        for (int k = n - 1; k >= 0; --k)
+        {
+            digits[k] = static_cast<int>(index % static_cast<std::uint64_t>(n - k));
+            index /= static_cast<std::uint64_t>(n - k);
+        }
+
+        Key key;
+        std::uint32_t used = 0;
+        for (int k = 0; k < n; ++k)
+        {
+            // The digit-th element not used yet
+            int v = 0;
+            for (int skip = digits[k]; skip > 0 || (used >> v & 1u); ++v)
+                if (!(used >> v & 1u))
+                    --skip;
+            key.push_back(v);
+            used |= 1u << v;
+        }
+        return key;
+    }
+
+    /*!*****************************************************************************
+     * @brief Finds a shortest sequence of blank moves between two states.
+     *
+     * @param starting
+     *     The tiles row by row, 0 for the blank.
+     *
+     * @param target
+     *     The tiles row by row, 0 for the blank.
+     *
+     * @return
+     *     A vector of characters with the moves of the blank, empty if there is none.
+    *******************************************************************************/
+    std::vector<char> PuzzleSolver::run(Key starting, Key target)
+    {
+        expanded = 0;
+        if (!getAdjacents.solvable(starting, target))
+            return {};
+
+        const std::uint64_t goal = GetPuzzleAdjacents::rank(target);
+        search(starting, goal);
+
+        // Walk back from the target, undoing the recorded moves
+        const char names[] = { 'N', 'S', 'W', 'E' };
+        const int width = getAdjacents.getWidth();
+        const std::uint64_t first = GetPuzzleAdjacents::rank(starting);
+        std::vector<char> path;
+        Key key = target;
+        for (std::uint64_t index = goal; index != first; index = GetPuzzleAdjacents::rank(key))
+        {
+            int move = (moves[index / 4] >> (index % 4 * 2)) & 3;
+            path.push_back(names[move]);
+
+            // The blank came from the opposite side
+            int blank = static_cast<int>(std::find(key.begin(), key.end(), 0) - key.begin());
+            int from = blank + (move == 0 ? width : move == 1 ? -width : move == 2 ? 1 : -1);
+            key.set(blank, key[from]);
+            key.set(from, 0);
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    /*!*****************************************************************************
+     * @brief Visits every state reachable from a state.
+     *
+     * @param starting
+     *     The tiles row by row, 0 for the blank.
+     *
+     * @return
+     *     The number of reachable states, the starting one included.
+    *******************************************************************************/
+    std::size_t PuzzleSolver::enumerate(Key starting)
+    {
+        expanded = 0;
+        return search(starting, std::numeric_limits<std::uint64_t>::max());
+    }
+
+    /*!*****************************************************************************
+     * @brief Searches until the target rank is closed or every state is visited.
+     *
+     * @param starting
+     *     The tiles row by row, 0 for the blank.
+     *
+     * @param target
+     *     The rank to stop at, or a value no state has to visit everything.
+     *
+     * @return
+     *     The number of states closed.
+    *******************************************************************************/
+    std::size_t PuzzleSolver::search(const Key& starting, std::uint64_t target)
+    {
+        std::uint64_t states = 1;
+        for (std::size_t k = 2; k <= starting.size(); ++k)
+            states *= k;
+
+        // Both arrays are cleared rather than freed, they are reused by the next run
+        closed.assign((states + 63) / 64, 0);
+        moves.assign((states + 3) / 4, 0);
+        open.clear();
+
+        const std::uint64_t first = GetPuzzleAdjacents::rank(starting);
+        closed[first / 64] |= std::uint64_t{ 1 } << (first % 64);
+        open.push_back(static_cast<std::uint32_t>(first));
+
+        const int n = static_cast<int>(starting.size());
+        for (std::size_t head = 0; head < open.size(); ++head)
+        {
+            std::uint64_t index = open[head];
+            if (index == target)
+                return head + 1;
+            ++expanded;
+
+            getAdjacents.adjacents(GetPuzzleAdjacents::unrank(index, n), list);
+            for (const Node& adjacent : list)
+            {
+                std::uint64_t next = GetPuzzleAdjacents::rank(adjacent.key);
+                std::uint64_t bit = std::uint64_t{ 1 } << (next % 64);
+                if (closed[next / 64] & bit)
+                    continue;
+                closed[next / 64] |= bit;
+
+                int move = adjacent.info == 'N' ? 0 : adjacent.info == 'S' ? 1 : adjacent.info == 'W' ? 2 : 3;
+                moves[next / 4] |= static_cast<std::uint8_t>(move << (next % 4 * 2));
+                open.push_back(static_cast<std::uint32_t>(next));
+            }
+        }
+        return open.size();
+    }
+
+    /*!*****************************************************************************
+     * @brief Constructs an empty PatternDatabase object; build() or load() fills it.
+     *
+     * @param width
+     *     The number of tiles per row.
+     *
+     * @param tiles
+     *     The tiles of the group, numbered like in the keys.
+    *******************************************************************************/
+    PatternDatabase::PatternDatabase(int width, const std::vector<int>& tiles)
+        : width{ width }, tiles{ tiles }, owned{}, table{ nullptr }, entries{ 1 }
+        , mapping{ nullptr }, mappedBytes{ 0 }
+    {
+        const std::size_t n = static_cast<std::size_t>(width) * width;
+        for (std::size_t k = 0; k < tiles.size(); ++k)
+            entries *= n - k;
+    }
+
+    /*!*****************************************************************************
+     * @brief Releases the table, unmapping the file if it was mapped.
+    *******************************************************************************/
+    PatternDatabase::~PatternDatabase()
+    {
+        release();
+    }
+
+    /*!*****************************************************************************
+     * @brief Fills the table with a breadth first search backwards from the goal.
+    *******************************************************************************/
+    void PatternDatabase::build()
+    {
+        // A search state is the cells of the group's tiles and of the blank,
+        // ranked like index() with the blank as the last digit. Moving the
+        // blank onto one of the group's tiles costs 1, onto any other tile 0,
+        // so the search keeps a deque with the free moves at the front.
+        const int n = width * width;
+        const int k = static_cast<int>(tiles.size());
+        const std::size_t states = entries * static_cast<std::size_t>(n - k);
+        const std::uint8_t UNSEEN = 0xFF;
+
+        auto encode = [n, k](const int* cells)
+        {
+            std::size_t state = 0;
+            std::uint32_t used = 0;
+            for (int d = 0; d <= k; ++d)
+            {
+                std::uint32_t below = used & ((1u << cells[d]) - 1);
+                int smaller = 0;
+                for (; below; below &= below - 1)
+                    ++smaller;
+                state = state * static_cast<std::size_t>(n - d) + static_cast<std::size_t>(cells[d] - smaller);
+                used |= 1u << cells[d];
+            }
+            return state;
+        };
+
+        auto decode = [n, k](std::size_t state, int* cells)
+        {
+            int digits[Key::CAPACITY + 1];
+            for (int d = k; d >= 0; --d)
+            {
+                digits[d] = static_cast<int>(state % static_cast<std::size_t>(n - d));
+                state /= static_cast<std::size_t>(n - d);
+            }
+            std::uint32_t used = 0;
+            for (int d = 0; d <= k; ++d)
+            {
+                int c = 0;
+                for (int skip = digits[d]; skip > 0 || (used >> c & 1u); ++c)
+                    if (!(used >> c & 1u))
+                        --skip;
+                cells[d] = c;
+                used |= 1u << c;
+            }
+        };
+
+        std::vector<std::uint8_t> distance(states, UNSEEN);
+        std::deque<std::uint32_t> open;
+
+        int cells[Key::CAPACITY + 1];
+        for (int d = 0; d < k; ++d)
+            cells[d] = tiles[d] - 1;
+        cells[k] = n - 1;
+        std::size_t goal = encode(cells);
+        distance[goal] = 0;
+        open.push_back(static_cast<std::uint32_t>(goal));
+
+        while (!open.empty())
+        {
+            std::size_t state = open.front();
+            open.pop_front();
+            const int cost = distance[state];
+            decode(state, cells);
+
+            const int blank = cells[k];
+            const int j = blank / width;
+            const int i = blank % width;
+            const int to[] = { blank - width, blank + width, blank - 1, blank + 1 };
+            const bool can[] = { j > 0, j < width - 1, i > 0, i < width - 1 };
+
+            for (int m = 0; m < 4; ++m)
+            {
+                if (!can[m])
+                    continue;
+
+                // The tile on the cell the blank moves to, if it is in the group
+                int moved = -1;
+                for (int d = 0; d < k; ++d)
+                    if (cells[d] == to[m])
+                        moved = d;
+
+                int next[Key::CAPACITY + 1];
+                std::copy(cells, cells + k + 1, next);
+                if (moved >= 0)
+                    next[moved] = blank;
+                next[k] = to[m];
+
+                std::size_t adjacent = encode(next);
+                int step = cost + (moved >= 0 ? 1 : 0);
+                if (step < distance[adjacent])
+                {
+                    distance[adjacent] = static_cast<std::uint8_t>(step);
+                    if (moved >= 0)
+                        open.push_back(static_cast<std::uint32_t>(adjacent));
+                    else
+                        open.push_front(static_cast<std::uint32_t>(adjacent));
+                }
+            }
+        }
+
+        // The blank is the last digit, so the states of one entry are adjacent
+        release();
+        owned.assign(entries, UNSEEN);
+        for (std::size_t state = 0; state < states; ++state)
+        {
+            std::uint8_t& entry = owned[state / static_cast<std::size_t>(n - k)];
+            entry = std::min(entry, distance[state]);
+        }
+        table = owned.data();
+    }
+
+    /*!*****************************************************************************
+     * @brief Builds several databases at the same time, one per thread.
+     *
+     * @param databases
+     *     The databases to build.
+     *
+     * @param threads
+     *     Number of worker threads, 0 uses one per hardware thread.
+    *******************************************************************************/
+    void PatternDatabase::build(const std::vector<PatternDatabase*>& databases, unsigned threads)
+    {
+        if (!threads)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        unsigned count = static_cast<unsigned>(std::min<std::size_t>(threads, databases.size()));
+
+        // The databases share nothing, so only the counter is shared
+        std::atomic<std::size_t> next{ 0 };
+        auto work = [&]()
+        {
+            for (std::size_t k = next.fetch_add(1, std::memory_order_relaxed); k < databases.size();
+                k = next.fetch_add(1, std::memory_order_relaxed))
+                databases[k]->build();
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned k = 1; k < count; ++k)
+            pool.emplace_back(work);
+        if (count > 0)
+            work();
+
+        for (std::thread& thread : pool)
+            thread.join();
+    }
+
+    /*!*****************************************************************************
+     * @brief Writes the group and the table to a binary file.
+     *
+     * @param path
+     *     The file to write.
+     *
+     * @return
+     *     `true` if the whole file was written.
+    *******************************************************************************/
+    bool PatternDatabase::save(const std::string& path) const
+    {
+        if (!table)
+            return false;
+
+        // "PDB1", the width, the number of tiles and the tiles, one byte each
+        std::vector<char> header{ 'P', 'D', 'B', '1', static_cast<char>(width), static_cast<char>(tiles.size()) };
+        for (int tile : tiles)
+            header.push_back(static_cast<char>(tile));
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(header.data(), static_cast<std::streamsize>(header.size()));
+        file.write(reinterpret_cast<const char*>(table), static_cast<std::streamsize>(entries));
+        return static_cast<bool>(file);
+    }
+
+    /*!*****************************************************************************
+     * @brief Maps a file written by save() for the same group, read only.
+     *
+     * @param path
+     *     The file to map. Where mmap is not available the file is read instead.
+     *
+     * @return
+     *     `true` if the file holds a table of this group.
+    *******************************************************************************/
+    bool PatternDatabase::load(const std::string& path)
+    {
+        release();
+
+        std::vector<char> header{ 'P', 'D', 'B', '1', static_cast<char>(width), static_cast<char>(tiles.size()) };
+        for (int tile : tiles)
+            header.push_back(static_cast<char>(tile));
+        const std::size_t bytes = header.size() + entries;
+
+#ifndef _WIN32
+        // The pages are shared with every process that maps the same file
+        // and are read from disk only when the search touches them
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        void* base = MAP_FAILED;
+        if (::fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) == bytes)
+            base = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED)
+            return false;
+
+        mapping = base;
+        mappedBytes = bytes;
+        if (std::memcmp(base, header.data(), header.size()) != 0)
+        {
+            release();
+            return false;
+        }
+        table = static_cast<const std::uint8_t*>(base) + header.size();
+#else
+        std::ifstream file(path, std::ios::binary);
+        std::vector<char> read(header.size());
+        if (!file.read(read.data(), static_cast<std::streamsize>(read.size())) || read != header)
+            return false;
+
+        owned.resize(entries);
+        if (!file.read(reinterpret_cast<char*>(owned.data()), static_cast<std::streamsize>(entries))
+            || file.peek() != std::char_traits<char>::eof())
+        {
+            owned.clear();
+            return false;
+        }
+        table = owned.data();
+#endif
+        return true;
+    }
+
+    /*!*****************************************************************************
+     * @brief Ranks the cells of the group's tiles as a partial permutation.
+     *
+     * @param where
+     *     The cell of every tile, indexed by tile.
+     *
+     * @return
+     *     The index of the table entry.
+    *******************************************************************************/
+    std::size_t PatternDatabase::index(const int* where) const
+    {
+        const std::size_t n = static_cast<std::size_t>(width) * width;
+        std::size_t entry = 0;
+        std::uint32_t used = 0;
+        for (std::size_t d = 0; d < tiles.size(); ++d)
+        {
+            int cell = where[tiles[d]];
+            std::uint32_t below = used & ((1u << cell) - 1);
+            int smaller = 0;
+            for (; below; below &= below - 1)
+                ++smaller;
+            entry = entry * (n - d) + static_cast<std::size_t>(cell - smaller);
+            used |= 1u << cell;
+        }
+        return entry;
+    }
+
+    /*!*****************************************************************************
+     * @brief Drops the table, unmapping the file if it was mapped.
+    *******************************************************************************/
+    void PatternDatabase::release()
+    {
+#ifndef _WIN32
+        if (mapping)
+            ::munmap(mapping, mappedBytes);
+#endif
+        mapping = nullptr;
+        mappedBytes = 0;
+        owned.clear();
+        table = nullptr;
+    }
+
+    /*!*****************************************************************************
+     * @brief Constructs a PuzzleIDAStar object.
+     *
+     * @param width
+     *     The number of tiles per row.
+     *
+     * @param databases
+     *     Ready databases of disjoint groups of tiles.
+    *******************************************************************************/
+    PuzzleIDAStar::PuzzleIDAStar(int width, const std::vector<const PatternDatabase*>& databases)
+        : width{ width }, databases{ databases }, owner(static_cast<std::size_t>(width) * width, -1)
+        , board{}, where{}, parts(databases.size(), 0), path{}, expanded{ 0 }
+    {
+        for (std::size_t d = 0; d < databases.size(); ++d)
+            for (int tile : databases[d]->getTiles())
+                owner[tile] = static_cast<int>(d);
+    }
+
+    /*!*****************************************************************************
+     * @brief Finds a shortest sequence of blank moves to the goal.
+     *
+     * @param starting
+     *     The tiles row by row, 0 for the blank.
+     *
+     * @return
+     *     A vector of characters with the moves of the blank, empty if there is none.
+    *******************************************************************************/
+    std::vector<char> PuzzleIDAStar::run(Key starting)
+    {
+        const int n = width * width;
+        expanded = 0;
+        path.clear();
+
+        Key goal;
+        for (int t = 1; t < n; ++t)
+            goal.push_back(t);
+        goal.push_back(0);
+        if (!GetPuzzleAdjacents{ width }.solvable(starting, goal))
+            return {};
+
+        board.assign(starting.begin(), starting.end());
+        where.assign(n, 0);
+        for (int c = 0; c < n; ++c)
+            where[board[c]] = c;
+        for (std::size_t d = 0; d < databases.size(); ++d)
+            parts[d] = (*databases[d])(where.data());
+
+        // Deepen the bound to the lowest f that went over it
+        for (int bound = 0; ; )
+        {
+            int h = 0;
+            for (int part : parts)
+                h += part;
+            bound = std::max(bound, h);
+
+            int next = search(where[0], 0, bound, -1);
+            if (next == FOUND)
+                return path;
+            if (next == std::numeric_limits<int>::max())
+                return {};
+            bound = next;
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Depth first search below a bound.
+     *
+     * @param blank
+     *     The cell of the blank.
+     *
+     * @param g
+     *     The cost so far.
+     *
+     * @param bound
+     *     The highest f searched in this iteration.
+     *
+     * @param back
+     *     The cell the blank came from, -1 at the root.
+     *
+     * @return
+     *     FOUND, or the lowest f over the bound.
+    *******************************************************************************/
+    int PuzzleIDAStar::search(int blank, int g, int bound, int back)
+    {
+        int h = 0;
+        for (int part : parts)
+            h += part;
+        if (g + h > bound)
+            return g + h;
+
+        // The databases may leave tiles out, so check the board itself
+        if (h == 0)
+        {
+            bool home = true;
+            for (std::size_t c = 0; c + 1 < board.size(); ++c)
+                home = home && board[c] == static_cast<int>(c) + 1;
+            if (home)
+                return FOUND;
+        }
+
+        ++expanded;
+        int lowest = std::numeric_limits<int>::max();
+
+        const int j = blank / width;
+        const int i = blank % width;
+        const int to[] = { blank - width, blank + width, blank - 1, blank + 1 };
+        const bool can[] = { j > 0, j < width - 1, i > 0, i < width - 1 };
+        const char move[] = { 'N', 'S', 'W', 'E' };
+
+        for (int m = 0; m < 4; ++m)
+        {
+            // Undoing the last move never helps
+            if (!can[m] || to[m] == back)
+                continue;
+
+            int tile = board[to[m]];
+            board[blank] = tile;
+            board[to[m]] = 0;
+            where[tile] = blank;
+            where[0] = to[m];
+
+            int d = owner[tile];
+            int old = d >= 0 ? parts[d] : 0;
+            if (d >= 0)
+                parts[d] = (*databases[d])(where.data());
+
+            path.push_back(move[m]);
+            int next = search(to[m], g + 1, bound, blank);
+            if (next == FOUND)
+                return FOUND;
+            path.pop_back();
+
+            if (d >= 0)
+                parts[d] = old;
+            board[to[m]] = tile;
+            board[blank] = 0;
+            where[tile] = to[m];
+            where[0] = blank;
+
+            lowest = std::min(lowest, next);
+        }
+        return lowest;
+    }
+
+    /*!*****************************************************************************
+     * @brief Constructs a Landmarks object without landmarks.
+     *
+     * @param map
+     *     A pointer to an array of integers representing the map, 0 for an empty cell.
+     *
+     * @param size
+     *     The width and height of the map in terms of the number of elements.
+    *******************************************************************************/
+    Landmarks::Landmarks(const int* map, int size)
+        : map{ map }, size{ size }, landmarks{}, distances{}
+    {
+    }
+
+    /*!*****************************************************************************
+     * @brief Picks landmarks by farthest point selection and fills their distances.
+     *
+     * @param count
+     *     The number of landmarks; fewer are picked if the map runs out of cells.
+    *******************************************************************************/
+    void Landmarks::build(int count)
+    {
+        landmarks.clear();
+        distances.clear();
+        if (count <= 0)
+            return;
+
+        // Label the connected regions of open cells, largest first
+        const std::size_t cells = static_cast<std::size_t>(size) * size;
+        std::vector<int> region(cells, -1);
+        std::vector<std::pair<std::size_t, std::size_t>> regions; // [cell count, first cell]
+        std::vector<std::size_t> open;
+        for (std::size_t first = 0; first < cells; ++first)
+        {
+            if (map[first] != 0 || region[first] != -1)
+                continue;
+
+            int id = static_cast<int>(regions.size());
+            open.assign(1, first);
+            region[first] = id;
+            for (std::size_t head = 0; head < open.size(); ++head)
+            {
+                std::size_t c = open[head];
+                std::size_t j = c / size;
+                std::size_t i = c % size;
+                const std::size_t to[] = { c - 1, c + 1, c - size, c + size };
+                const bool can[] = { i > 0, i + 1 < static_cast<std::size_t>(size), j > 0, j + 1 < static_cast<std::size_t>(size) };
+                for (int d = 0; d < 4; ++d)
+                    if (can[d] && map[to[d]] == 0 && region[to[d]] == -1)
+                    {
+                        region[to[d]] = id;
+                        open.push_back(to[d]);
+                    }
+            }
+            regions.emplace_back(open.size(), first);
+        }
+        std::stable_sort(regions.begin(), regions.end(),
+            [](const std::pair<std::size_t, std::size_t>& a, const std::pair<std::size_t, std::size_t>& b)
+            { return a.first > b.first; });
+
+        // Each pick needs the distances of the one before, so the landmarks
+        // are found one after the other; the tables are kept, not redone
+        std::vector<std::vector<std::uint16_t>> tables;
+        std::vector<std::uint16_t> table;
+        std::vector<std::uint16_t> nearest(cells, UNREACHABLE);
+        std::size_t seeded = 0;
+
+        while (static_cast<int>(landmarks.size()) < count)
+        {
+            // The covered cell farthest from its nearest landmark
+            std::size_t farthest = cells;
+            for (std::size_t c = 0; c < cells; ++c)
+                if (nearest[c] != UNREACHABLE && (farthest == cells || nearest[c] > nearest[farthest]))
+                    farthest = c;
+            std::size_t gap = farthest == cells ? 0 : nearest[farthest];
+
+            // A region without landmarks gets one once it has more cells than
+            // that gap, so small pockets do not take landmarks from large regions
+            std::size_t next = cells;
+            if (seeded < regions.size() && regions[seeded].first > std::max<std::size_t>(gap, 1))
+            {
+                // The first landmark of a region is its cell farthest from its first cell
+                std::size_t first = regions[seeded++].second;
+                flood(GridKey{ static_cast<int>(first / size), static_cast<int>(first % size) }, table);
+                next = first;
+                for (std::size_t c = 0; c < cells; ++c)
+                    if (table[c] != UNREACHABLE && table[c] > table[next])
+                        next = c;
+            }
+            else if (gap > 0)
+                next = farthest;
+            else
+                break;
+
+            landmarks.push_back(GridKey{ static_cast<int>(next / size), static_cast<int>(next % size) });
+            flood(landmarks.back(), table);
+            tables.push_back(table);
+            for (std::size_t c = 0; c < cells; ++c)
+                nearest[c] = std::min(nearest[c], table[c]);
+        }
+
+        interleave(tables);
+    }
+
+    /*!*****************************************************************************
+     * @brief Fills the distances of the current landmarks again, one landmark per thread.
+     *
+     * @param threads
+     *     Number of worker threads, 0 uses one per hardware thread.
+    *******************************************************************************/
+    void Landmarks::rebuild(unsigned threads)
+    {
+        if (!threads)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        unsigned count = static_cast<unsigned>(std::min<std::size_t>(threads, landmarks.size()));
+
+        // Each table has its own slot, so only the counter is shared
+        std::vector<std::vector<std::uint16_t>> tables(landmarks.size());
+        std::atomic<std::size_t> next{ 0 };
+        auto work = [&]()
+        {
+            for (std::size_t k = next.fetch_add(1, std::memory_order_relaxed); k < landmarks.size();
+                k = next.fetch_add(1, std::memory_order_relaxed))
+                flood(landmarks[k], tables[k]);
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned k = 1; k < count; ++k)
+            pool.emplace_back(work);
+        if (count > 0)
+            work();
+
+        for (std::thread& thread : pool)
+            thread.join();
+        interleave(tables);
+    }
+
+    /*!*****************************************************************************
+     * @brief Writes the landmarks and their distances to a binary file.
+     *
+     * @param path
+     *     The file to write.
+     *
+     * @return
+     *     `true` if the whole file was written.
+    *******************************************************************************/
+    bool Landmarks::save(const std::string& path) const
+    {
+        // "ALT1", the map size and the landmark count, the landmarks [j, i],
+        // then the distances, all in the byte order of this machine
+        std::vector<std::int32_t> header{ size, static_cast<std::int32_t>(landmarks.size()) };
+        for (const GridKey& landmark : landmarks)
+        {
+            header.push_back(landmark[0]);
+            header.push_back(landmark[1]);
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        file.write("ALT1", 4);
+        file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size() * sizeof(std::int32_t)));
+        file.write(reinterpret_cast<const char*>(distances.data()),
+            static_cast<std::streamsize>(distances.size() * sizeof(std::uint16_t)));
+        return static_cast<bool>(file);
+    }
+
+    /*!*****************************************************************************
+     * @brief Reads a file written by save() for a map of the same size.
+     *
+     * @param path
+     *     The file to read.
+     *
+     * @return
+     *     `true` if the file holds landmarks of a map of this size.
+    *******************************************************************************/
+    bool Landmarks::load(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        char magic[4] = {};
+        std::int32_t header[2] = {};
+        if (!file.read(magic, 4) || std::memcmp(magic, "ALT1", 4) != 0
+            || !file.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != size || header[1] < 0)
+            return false;
+
+        std::vector<std::int32_t> cells(static_cast<std::size_t>(header[1]) * 2);
+        std::vector<std::uint16_t> read(static_cast<std::size_t>(size) * size * header[1]);
+        if (!file.read(reinterpret_cast<char*>(cells.data()), static_cast<std::streamsize>(cells.size() * sizeof(std::int32_t)))
+            || !file.read(reinterpret_cast<char*>(read.data()), static_cast<std::streamsize>(read.size() * sizeof(std::uint16_t)))
+            || file.peek() != std::char_traits<char>::eof())
+            return false;
+
+        landmarks.clear();
+        for (std::size_t k = 0; k < cells.size(); k += 2)
+            landmarks.push_back(GridKey{ cells[k], cells[k + 1] });
+        distances.swap(read);
+        return true;
+    }
+
+    /*!*****************************************************************************
+     * @brief Returns the moves between a landmark and a cell.
+     *
+     * @param landmark
+     *     The index of the landmark.
+     *
+     * @param cell
+     *     The cell [j, i].
+     *
+     * @return
+     *     The number of moves, or UNREACHABLE.
+    *******************************************************************************/
+    int Landmarks::distance(std::size_t landmark, const Key& cell) const
+    {
+        std::size_t c = static_cast<std::size_t>(cell[0]) * size + cell[1];
+        return distances[c * landmarks.size() + landmark];
+    }
+
+    /*!*****************************************************************************
+     * @brief Lower bound on the moves between two cells from the triangle inequality.
+     *
+     * @param a
+     *     The first cell [j, i].
+     *
+     * @param b
+     *     The second cell [j, i].
+     *
+     * @return
+     *     The largest difference of the distances of a landmark that reaches both,
+     *     0 without landmarks.
+    *******************************************************************************/
+    int Landmarks::estimate(const Key& a, const Key& b) const
+    {
+        const std::size_t count = landmarks.size();
+        if (count == 0)
+            return 0;
+
+        const std::uint16_t* da = &distances[(static_cast<std::size_t>(a[0]) * size + a[1]) * count];
+        const std::uint16_t* db = &distances[(static_cast<std::size_t>(b[0]) * size + b[1]) * count];
+
+        int best = 0;
+        for (std::size_t l = 0; l < count; ++l)
+            if (da[l] != UNREACHABLE && db[l] != UNREACHABLE)
+                best = std::max(best, std::abs(static_cast<int>(da[l]) - static_cast<int>(db[l])));
+        return best;
+    }
+
+    /*!*****************************************************************************
+     * @brief Moves from a cell to every cell, by a breadth first search.
+     *
+     * @param from
+     *     The cell [j, i] to start from.
+     *
+     * @param table
+     *     Receives the moves of every cell, UNREACHABLE where there is no path.
+    *******************************************************************************/
+    void Landmarks::flood(const GridKey& from, std::vector<std::uint16_t>& table) const
+    {
+        // Every move costs the same, so a breadth first search is Dijkstra's
+        const std::size_t cells = static_cast<std::size_t>(size) * size;
+        table.assign(cells, UNREACHABLE);
+
+        std::vector<int> open;
+        open.reserve(cells);
+        int start = from[0] * size + from[1];
+        table[start] = 0;
+        open.push_back(start);
+
+        for (std::size_t head = 0; head < open.size(); ++head)
+        {
+            int c = open[head];
+            int j = c / size;
+            int i = c % size;
+            std::uint16_t moves = static_cast<std::uint16_t>(std::min<int>(table[c] + 1, UNREACHABLE - 1));
+
+            const int to[] = { c - 1, c + 1, c - size, c + size };
+            const bool can[] = { i > 0, i < size - 1, j > 0, j < size - 1 };
+            for (int d = 0; d < 4; ++d)
+                if (can[d] && map[to[d]] == 0 && table[to[d]] == UNREACHABLE)
+                {
+                    table[to[d]] = moves;
+                    open.push_back(to[d]);
+                }
+        }
+    }
+
+    /*!*****************************************************************************
+     * @brief Stores the tables of all landmarks cell by cell.
+     *
+     * @param tables
+     *     The table of every landmark, in the order of the landmarks.
+    *******************************************************************************/
+    void Landmarks::interleave(const std::vector<std::vector<std::uint16_t>>& tables)
+    {
+        const std::size_t cells = static_cast<std::size_t>(size) * size;
+        const std::size_t count = tables.size();
+        distances.assign(cells * count, UNREACHABLE);
+        for (std::size_t l = 0; l < count; ++l)
+            for (std::size_t c = 0; c < cells; ++c)
+                distances[c * count + l] = tables[l][c];
+    }
+
+    /*!*****************************************************************************
+     * @brief Landmark estimate between two grid keys, at least the Manhattan distance.
+     *
+     * @param a
+     *     The first key [j, i].
+     *
+     * @param b
+     *     The second key [j, i].
+     *
+     * @return
+     *     Cost of the moves from a to b that the landmarks prove are needed.
+    *******************************************************************************/
+    int LandmarkHeuristic::operator()(const Key& a, const Key& b) const
+    {
+        int moves = std::abs(a[0] - b[0]) + std::abs(a[1] - b[1]);
+        if (landmarks)
+            moves = std::max(moves, landmarks->estimate(a, b));
+        return cost * moves;
+    }
+
+    template class AStar<LandmarkHeuristic>;
+
 } // end namespace
\ No newline at end of file
@@ -21,9 +21,27 @@ Technology is prohibited.
 
 #include "data.h"
 #include <algorithm>
+#include <functional>
+#include <utility>
+#include <memory>
+#include <limits>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #define UNUSED(x) (void)x;
 
+// Search counters are compiled in only with AI_SEARCH_STATS defined, e.g.
+// by make STATS=1; otherwise AI_STATS(statement) expands to nothing
+#ifdef AI_SEARCH_STATS
+#define AI_STATS(statement) statement
+#else
+#define AI_STATS(statement)
+#endif
+
 namespace AI 
 {
 
@@ -61,11 +79,82 @@ namespace AI
             A vector of pointers to AI::Node objects representing the adjacent nodes.
         *******************************************************************************/
         std::vector<AI::Node*> operator()(Key key);
+
+        /*!*****************************************************************************
+         * \brief
+            Find all empty adjacent cells without allocating nodes
+         *
+         * \param key
+            The key for which adjacent nodes are to be retrieved.
+         *
+         * \param list
+            The vector that receives the adjacent nodes, replacing its contents.
+        *******************************************************************************/
+        void adjacents(Key key, std::vector<AI::Node>& list);
+
+        /*!*****************************************************************************
+         * \brief
+            Find and return all empty cells that can move into a cell
+         *
+         * \param key
+            The key for which the previous nodes are to be retrieved.
+         *
+         * \return
+            A vector of pointers to AI::Node objects whose moves lead into the key.
+        *******************************************************************************/
+        std::vector<AI::Node*> reverse(Key key);
+
+        /*!*****************************************************************************
+         * \brief
+            Returns the cost of one move, the same for every move on the map
+        *******************************************************************************/
+        int maxCost() const { return 10; }
+    };
+
+    /*!*****************************************************************************
+     * @brief Retrieves the moves from the starting point to a node.
+     *
+     * @param pNode
+     *     Pointer to the last node of the path, or nullptr if there is no path.
+     *
+     * @return
+     *     A vector of characters representing the moves along the parent links.
+    *******************************************************************************/
+    std::vector<char> tracePath(const Node* pNode);
+
+    // What the last search did, filled in only when compiled with
+    // AI_SEARCH_STATS and all zero otherwise
+    struct SearchStats
+    {
+#ifdef AI_SEARCH_STATS
+        static constexpr bool ENABLED = true;
+#else
+        static constexpr bool ENABLED = false;
+#endif
+        std::size_t expanded = 0;   // nodes whose adjacents were generated
+        std::size_t generated = 0;  // adjacents returned by the GetAdjacents object
+        std::size_t decreased = 0;  // open nodes that got a cheaper path
+        std::size_t peakOpen = 0;   // most nodes in the open list at once
+        std::size_t closed = 0;     // nodes in the closed list at the end
+        double searchSeconds = 0.0; // expanding nodes
+        double pathSeconds = 0.0;   // tracing the path and freeing the lists
     };
 
+    // Dijkstra's algorithm. When the adjacents report a small largest edge
+    // cost the open list is a BucketQueue, otherwise an IndexedHeap.
     class Dijkstras
     {
+        // Largest edge cost that still gets a bucket per cost
+        static const int MAX_BUCKETS = 4096;
+
         GetAdjacents* pGetAdjacents;
+        NodePool<> pool;           // owns the nodes of both lists during a run
+        IndexedHeap<> openlist;    // kept between runs so memory is reused
+        BucketQueue<> buckets;
+        FlatHashTable<> closedlist;
+        std::vector<Node> adjacents;
+        std::size_t expanded;
+        SearchStats stats;
 
     public:
 
@@ -77,7 +166,8 @@ namespace AI
          *     The Dijkstras object takes ownership of the provided GetAdjacents object.
         *******************************************************************************/
         Dijkstras(GetAdjacents* pGetAdjacents)
-            : pGetAdjacents(pGetAdjacents)
+            : pGetAdjacents(pGetAdjacents), pool{}, openlist{}, buckets{}, closedlist{}
+            , adjacents{}, expanded{ 0 }, stats{}
         {
         }
 
@@ -96,7 +186,35 @@ namespace AI
         *******************************************************************************/
         std::vector<char> run(Key starting, Key target);
 
+        /*!*****************************************************************************
+         * @brief Returns the number of nodes expanded by the last run.
+        *******************************************************************************/
+        std::size_t getExpanded() const { return expanded; }
+
+        /*!*****************************************************************************
+         * @brief Returns the counters of the last run, all zero unless compiled with AI_SEARCH_STATS.
+        *******************************************************************************/
+        const SearchStats& getStats() const { return stats; }
+
     private:
+        /*!*****************************************************************************
+         * @brief Searches with the given open list until the target is closed.
+         *
+         * @param open
+         *     The empty open list to use.
+         *
+         * @param starting
+         *     An array of 2 elements [j, i] representing the starting position on the map.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+         *
+         * @return
+         *     The closed target node, or nullptr if it cannot be reached.
+        *******************************************************************************/
+        template<typename Q>
+        Node* search(Q& open, const Key& starting, const Key& target);
+
         /*!*****************************************************************************
          * @brief Retrieves the path from a given node to the starting point.
          *
@@ -121,8 +239,1532 @@ namespace AI
          * @return
          *     `true` if the arrays are equal, `false` otherwise.
         *******************************************************************************/
-        bool compareArrays(Key current, Key target);
+        bool compareArrays(const Key& current, const Key& target);
+    };
+
+    // Dijkstra's algorithm run from the start on the adjacents and from the
+    // target on the reverse adjacents at the same time. The side with the
+    // cheaper top node is expanded, every edge that reaches a node seen by the
+    // other side is a candidate path, and the search stops once the two tops
+    // together cost no less than the best candidate. A long query explores
+    // two disks of half the radius, about half the nodes of Dijkstras.
+    class BidirectionalDijkstras
+    {
+        GetAdjacents* pGetAdjacents;
+        IndexedHeap<> forward;     // kept between runs so memory is reused
+        IndexedHeap<> backward;
+        FlatHashTable<> forwardClosed;
+        FlatHashTable<> backwardClosed;
+        std::size_t expanded;
+
+        // Best path found so far: start .. meetForward, meetMove, meetBackward .. target
+        int best;
+        Node* meetForward;
+        char meetMove;
+        Node* meetBackward;
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs a BidirectionalDijkstras object.
+         *
+         * @param pGetAdjacents
+         *     Pointer to a GetAdjacents object that provides the adjacent and the reverse adjacent nodes.
+        *******************************************************************************/
+        BidirectionalDijkstras(GetAdjacents* pGetAdjacents)
+            : pGetAdjacents(pGetAdjacents), forward{}, backward{}
+            , forwardClosed{}, backwardClosed{}, expanded{ 0 }
+            , best{ 0 }, meetForward{ nullptr }, meetMove{ 0 }, meetBackward{ nullptr }
+        {
+        }
+
+        /*!*****************************************************************************
+         * @brief Runs both searches to find the path from the starting position to the target position.
+         *
+         * @param starting
+         *     An array of 2 elements [j, i] representing the starting position on the map.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+         *
+         * @return
+         *     A vector of characters representing the path from the starting position to the target position.
+        *******************************************************************************/
+        std::vector<char> run(Key starting, Key target);
+
+        /*!*****************************************************************************
+         * @brief Returns the number of nodes expanded by both sides in the last run.
+        *******************************************************************************/
+        std::size_t getExpanded() const { return expanded; }
+
+    private:
+
+        /*!*****************************************************************************
+         * @brief Expands the top node of one side and records any path that meets the other side.
+         *
+         * @param isForward
+         *     Expands the search from the start if true, the one from the target otherwise.
+        *******************************************************************************/
+        void expand(bool isForward);
+    };
+
+    // Runs many independent Dijkstras queries on several threads. The workers
+    // are started once and sleep between batches, and the calling thread works
+    // on every batch as well. Every worker owns a Dijkstras object whose open
+    // and closed lists are reused from one query to the next and from one
+    // batch to the next. Workers claim queries from a shared counter and write
+    // each path at the index of its query. The GetAdjacents object is shared
+    // and must be safe to call concurrently, which GetMapAdjacents is as long
+    // as the map does not change.
+    class BatchDijkstras
+    {
+        std::vector<std::unique_ptr<Dijkstras>> workspaces; // one per thread, the caller's first
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable wake;   // a batch was published or the pool stops
+        std::condition_variable done;   // the last worker finished the batch
+        unsigned generation;            // number of batches published
+        unsigned busy;                  // workers still on the current batch
+        bool stopping;
+
+        const std::vector<std::pair<Key, Key>>* pQueries;
+        std::vector<std::vector<char>>* pPaths;
+        std::atomic<std::size_t> next;
+
+        /*!*****************************************************************************
+         * @brief Runs queries of the current batch until none is left.
+         *
+         * @param self
+         *     Index of the workspace of the calling thread.
+        *******************************************************************************/
+        void drain(unsigned self);
+
+        /*!*****************************************************************************
+         * @brief Body of a worker thread, waits for batches until the pool stops.
+         *
+         * @param self
+         *     Index of the workspace of the worker.
+        *******************************************************************************/
+        void serve(unsigned self);
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs a BatchDijkstras object.
+         *
+         * @param pGetAdjacents
+         *     Pointer to a GetAdjacents object that provides the function to retrieve adjacent nodes.
+         *
+         * @param threads
+         *     Number of worker threads, 0 uses one per hardware thread.
+        *******************************************************************************/
+        BatchDijkstras(GetAdjacents* pGetAdjacents, unsigned threads = 0);
+
+        /*!*****************************************************************************
+         * @brief Stops and joins the worker threads.
+        *******************************************************************************/
+        ~BatchDijkstras();
+
+        BatchDijkstras(const BatchDijkstras&) = delete;
+        BatchDijkstras& operator=(const BatchDijkstras&) = delete;
+
+        /*!*****************************************************************************
+         * @brief Returns the number of threads working on a batch, the caller included.
+        *******************************************************************************/
+        unsigned getThreads() const { return static_cast<unsigned>(workspaces.size()); }
+
+        /*!*****************************************************************************
+         * @brief Finds the paths of all queries.
+         *
+         * @param queries
+         *     Pairs of starting and target positions [j, i].
+         *
+         * @return
+         *     The path of every query, in the order of the queries.
+        *******************************************************************************/
+        std::vector<std::vector<char>> run(const std::vector<std::pair<Key, Key>>& queries);
+    };
+
+    // Cache of Dijkstras paths on a GetMapAdjacents style grid, keyed by the
+    // start and the target and evicting the least recently used path when it
+    // is full. Every cell remembers the cached paths that cross it, so a map
+    // edit drops only the paths through the edited cells. A path kept after an
+    // edit is still walkable, though removing a wall elsewhere may have made
+    // a shorter one. Unreachable targets are not cached.
+    class PathCache
+    {
+        struct Entry
+        {
+            Key query;              // [start j, start i, target j, target i]
+            std::vector<char> path;
+            unsigned stamp;         // changes whenever the entry is dropped
+            std::size_t prev;       // towards the most recently used entry
+            std::size_t next;       // towards the least recently used entry
+        };
+
+        // Cached path crossing a cell, ignored once the entry's stamp moved on
+        struct Ref
+        {
+            std::size_t entry;
+            unsigned stamp;
+        };
+
+        static const std::size_t NONE = static_cast<std::size_t>(-1);
+
+        Dijkstras dijkstras;
+        std::size_t capacity;
+        std::vector<Entry> entries;
+        std::vector<std::size_t> unused;
+        std::size_t newest;
+        std::size_t oldest;
+        std::size_t live;
+
+        FlatMap<std::size_t> lookup;             // query to entry, NONE once dropped
+        FlatMap<std::vector<Ref>, GridKey> users; // cell to the paths crossing it
+        std::vector<char> scratch;               // result that is not cached
+        std::size_t hits;
+        std::size_t misses;
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs a PathCache object.
+         *
+         * @param pGetAdjacents
+         *     Pointer to a GetAdjacents object that provides the function to retrieve adjacent nodes.
+         *
+         * @param capacity
+         *     Number of paths kept before the least recently used one is evicted.
+        *******************************************************************************/
+        PathCache(GetAdjacents* pGetAdjacents, std::size_t capacity = 1024);
+
+        /*!*****************************************************************************
+         * @brief Returns the cached path, searching for it only if it is not cached.
+         *
+         * @param starting
+         *     An array of 2 elements [j, i] representing the starting position on the map.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+         *
+         * @return
+         *     The moves from the starting position to the target position, valid until
+         *     the next call that changes the cache.
+        *******************************************************************************/
+        const std::vector<char>& run(Key starting, Key target);
+
+        /*!*****************************************************************************
+         * @brief Drops the cached paths that cross any of the edited cells.
+         *
+         * @param cells
+         *     The positions [j, i] of the cells that were changed on the map.
+        *******************************************************************************/
+        void mapChanged(const std::vector<Key>& cells);
+
+        /*!*****************************************************************************
+         * @brief Returns the number of cached paths.
+        *******************************************************************************/
+        std::size_t size() const { return live; }
+
+        /*!*****************************************************************************
+         * @brief Returns the number of queries answered from the cache.
+        *******************************************************************************/
+        std::size_t getHits() const { return hits; }
+
+        /*!*****************************************************************************
+         * @brief Returns the number of queries that needed a search.
+        *******************************************************************************/
+        std::size_t getMisses() const { return misses; }
+
+    private:
+
+        /*!*****************************************************************************
+         * @brief Makes an entry the most recently used one.
+        *******************************************************************************/
+        void pushFront(std::size_t e);
+
+        /*!*****************************************************************************
+         * @brief Takes an entry out of the recently used order.
+        *******************************************************************************/
+        void unlink(std::size_t e);
+
+        /*!*****************************************************************************
+         * @brief Drops an entry and frees it for the next path.
+        *******************************************************************************/
+        void remove(std::size_t e);
+    };
+
+    // Dijkstra's algorithm specialized for GetMapAdjacents style grids. The
+    // costs and the move into every cell live in flat arrays indexed by
+    // j * size + i; the parent of a cell follows from its move. A cell is valid
+    // for the current query only if its stamp equals the generation, so a new
+    // query resets everything in O(1) and does not allocate after warm-up.
+    class GridDijkstras
+    {
+        const int* map; // the map with integers where 0 means an empty cell
+        int size;       // width and hight of the map in elements
+
+        std::vector<int> g;
+        std::vector<char> move;
+        std::vector<unsigned> seen;   // g and move are valid
+        std::vector<unsigned> closed; // g is final
+        unsigned generation;
+
+        std::vector<std::pair<int, int>> heap; // (g, cell), stale entries skipped
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs a GridDijkstras object.
+         *
+         * @param map
+         *     A pointer to an array of integers representing the map.
+         *
+         * @param size
+         *     The width and height of the map in terms of the number of elements.
+        *******************************************************************************/
+        GridDijkstras(const int* map = nullptr, int size = 0);
+
+        /*!*****************************************************************************
+         * @brief Runs Dijkstra's algorithm to find the path from the starting position to the target position.
+         *
+         * @param starting
+         *     An array of 2 elements [j, i] representing the starting position on the map.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+         *
+         * @return
+         *     A vector of characters representing the path from the starting position to the target position.
+        *******************************************************************************/
+        std::vector<char> run(Key starting, Key target);
+
+        /*!*****************************************************************************
+         * @brief Runs Dijkstra's algorithm and writes the path into a reused vector.
+         *
+         * @param starting
+         *     An array of 2 elements [j, i] representing the starting position on the map.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+         *
+         * @param path
+         *     Receives the moves; left empty if the target cannot be reached.
+        *******************************************************************************/
+        void run(Key starting, Key target, std::vector<char>& path);
+
+    private:
+
+        /*!*****************************************************************************
+         * @brief Invalidates the results of the previous query.
+        *******************************************************************************/
+        void nextGeneration();
     };
+
+    // Distances and moves from every cell of a GetMapAdjacents style grid to
+    // one target, kept in flat arrays indexed by j * size + i. Any number of
+    // agents heading to the target read their next move in O(1). The field is
+    // only rebuilt by update() after the target or the map has changed.
+    class FlowField
+    {
+        const int* map; // the map with integers where 0 means an empty cell
+        int size;       // width and hight of the map in elements
+
+        std::vector<int> distance;   // cost to the target, -1 if unreachable
+        std::vector<char> direction; // move towards the target, 0 if none
+        std::vector<int> queue;      // cells in the order they were reached
+        int target;
+        bool dirty;
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs a FlowField object without a target.
+         *
+         * @param map
+         *     A pointer to an array of integers representing the map.
+         *
+         * @param size
+         *     The width and height of the map in terms of the number of elements.
+        *******************************************************************************/
+        FlowField(const int* map = nullptr, int size = 0);
+
+        /*!*****************************************************************************
+         * @brief Sets the target; the field is rebuilt by the next update if it moved.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+        *******************************************************************************/
+        void setTarget(Key target);
+
+        /*!*****************************************************************************
+         * @brief Marks the field as stale after cells of the map were changed.
+        *******************************************************************************/
+        void mapChanged();
+
+        /*!*****************************************************************************
+         * @brief Rebuilds the field if the target or the map changed since the last build.
+         *
+         * @return
+         *     True if the field was rebuilt.
+        *******************************************************************************/
+        bool update();
+
+        /*!*****************************************************************************
+         * @brief Returns the next move from a cell towards the target.
+         *
+         * @param key
+         *     An array of 2 elements [j, i] representing the position of the agent.
+         *
+         * @return
+         *     'W', 'E', 'N' or 'S', or 0 at the target and where it cannot be reached.
+        *******************************************************************************/
+        char next(Key key) const;
+
+        /*!*****************************************************************************
+         * @brief Returns the cost from a cell to the target.
+         *
+         * @param key
+         *     An array of 2 elements [j, i] representing the position of the agent.
+         *
+         * @return
+         *     The cost of the path, or -1 if the target cannot be reached.
+        *******************************************************************************/
+        int getDistance(Key key) const;
+
+        /*!*****************************************************************************
+         * @brief Follows the field from a cell to the target.
+         *
+         * @param key
+         *     An array of 2 elements [j, i] representing the position of the agent.
+         *
+         * @return
+         *     A vector of characters representing the path to the target.
+        *******************************************************************************/
+        std::vector<char> getPath(Key key) const;
+
+    private:
+
+        /*!*****************************************************************************
+         * @brief Converts a key to its cell, or -1 if it is outside the map.
+        *******************************************************************************/
+        int cellOf(const Key& key) const
+        {
+            return (key[0] >= 0 && key[0] < size && key[1] >= 0 && key[1] < size)
+                ? key[0] * size + key[1] : -1;
+        }
+    };
+
+    // Hierarchical path finding (HPA*) for large GetMapAdjacents style grids.
+    // The map is cut into square clusters. Every run of open cells along the
+    // border of two clusters gets one or two entrances, and the cost between
+    // the entrances of a cluster is found once by a search inside it. A query
+    // links the start and the target to the entrances of their clusters,
+    // searches the small graph of entrances with A* and then refines every
+    // step of that path with a search inside one cluster. Paths are close to
+    // the shortest but not always the shortest. The start and the target must
+    // be empty cells. Map edits rebuild only the clusters whose cells or
+    // entrances changed.
+    class HPAStar
+    {
+        struct Cluster
+        {
+            std::vector<int> nodes; // entrance cells inside the cluster
+            std::vector<int> costs; // nodes x nodes, -1 if not connected inside
+        };
+
+        // Entrance pair across the border of two clusters
+        struct Transition
+        {
+            int inside;
+            int across;
+
+            bool operator==(const Transition& rhs) const
+            {
+                return inside == rhs.inside && across == rhs.across;
+            }
+        };
+
+        using AbstractNode = BasicNode<GridKey>;
+
+        const int* map;  // the map with integers where 0 means an empty cell
+        int size;        // width and hight of the map in elements
+        int clusterSize; // width and hight of a cluster in elements
+        int clusters;    // clusters per side
+
+        std::vector<Cluster> clusterList;
+        std::vector<std::vector<Transition>> east;  // entrances to the next cluster on the right
+        std::vector<std::vector<Transition>> south; // entrances to the next cluster below
+
+        // Breadth first search inside one cluster
+        std::vector<int> distance;
+        std::vector<char> move;
+        std::vector<unsigned> seen;
+        std::vector<int> queue;
+        unsigned generation;
+        int explored; // cluster of the last search
+
+        IndexedHeap<GridKey> openlist; // kept between runs so memory is reused
+        FlatHashTable<GridKey> closedlist;
+        std::size_t expanded;
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs an HPAStar object and builds the clusters.
+         *
+         * @param map
+         *     A pointer to an array of integers representing the map.
+         *
+         * @param size
+         *     The width and height of the map in terms of the number of elements.
+         *
+         * @param clusterSize
+         *     The width and height of a cluster in terms of the number of elements.
+        *******************************************************************************/
+        HPAStar(const int* map = nullptr, int size = 0, int clusterSize = 16);
+
+        /*!*****************************************************************************
+         * @brief Finds a path through the entrances and refines it into moves.
+         *
+         * @param starting
+         *     An array of 2 elements [j, i] representing the starting position on the map.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+         *
+         * @return
+         *     A vector of characters representing the path from the starting position to the target position.
+        *******************************************************************************/
+        std::vector<char> run(Key starting, Key target);
+
+        /*!*****************************************************************************
+         * @brief Rebuilds the clusters affected by edited cells.
+         *
+         * @param cells
+         *     The positions [j, i] of the cells that were changed on the map.
+        *******************************************************************************/
+        void mapChanged(const std::vector<Key>& cells);
+
+        /*!*****************************************************************************
+         * @brief Returns the number of entrances in all clusters.
+        *******************************************************************************/
+        std::size_t getNodeCount() const;
+
+        /*!*****************************************************************************
+         * @brief Returns the number of entrances expanded by the last abstract search.
+        *******************************************************************************/
+        std::size_t getExpanded() const { return expanded; }
+
+    private:
+
+        /*!*****************************************************************************
+         * @brief Returns the cluster that holds a cell.
+        *******************************************************************************/
+        int clusterOf(int cell) const
+        {
+            return (cell / size / clusterSize) * clusters + (cell % size) / clusterSize;
+        }
+
+        /*!*****************************************************************************
+         * @brief Returns the position of a cell in the nodes of a cluster, or -1.
+        *******************************************************************************/
+        int indexOf(int cluster, int cell) const;
+
+        /*!*****************************************************************************
+         * @brief Finds the entrances on the right and the bottom border of a cluster.
+         *
+         * @param cluster
+         *     The cluster that owns the two borders.
+        *******************************************************************************/
+        void findEntrances(int cluster);
+
+        /*!*****************************************************************************
+         * @brief Collects the entrances of a cluster and the costs between them.
+         *
+         * @param cluster
+         *     The cluster to build.
+        *******************************************************************************/
+        void buildCluster(int cluster);
+
+        /*!*****************************************************************************
+         * @brief Searches breadth first from a cell without leaving its cluster.
+         *
+         * @param from
+         *     The cell to start from.
+        *******************************************************************************/
+        void explore(int from);
+
+        /*!*****************************************************************************
+         * @brief Cost from the cell of the last explore to a cell of the same cluster.
+         *
+         * @return
+         *     The cost, or -1 if the cell was not reached.
+        *******************************************************************************/
+        int distanceTo(int cell) const;
+
+        /*!*****************************************************************************
+         * @brief Appends the moves from the cell of the last explore to another cell.
+        *******************************************************************************/
+        void appendMoves(int to, std::vector<char>& path);
+    };
+
+    // Jump Point Search for GetMapAdjacents style grids where every move has
+    // the same cost. Straight runs are scanned without touching the open list
+    // and only jump points, where an obstacle forces a turn, are expanded.
+    // With diagonal moves a diagonal step costs 14, may not cut a corner and
+    // is written as its vertical move followed by its horizontal move, so the
+    // path is always walkable with the 4 moves of GetMapAdjacents.
+    class JumpPointSearch
+    {
+        const int* map; // the map with integers where 0 means an empty cell
+        int size;       // width and hight of the map in elements
+        bool diagonal;  // 8-connected instead of 4-connected
+
+        std::vector<int> g;
+        std::vector<int> parent;      // previous jump point
+        std::vector<unsigned> seen;   // g and parent are valid
+        std::vector<unsigned> closed; // g is final
+        unsigned generation;
+
+        std::vector<std::pair<int, int>> heap; // (f, cell), stale entries skipped
+        int goal;
+        int cost;
+        std::size_t expanded;
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs a JumpPointSearch object.
+         *
+         * @param map
+         *     A pointer to an array of integers representing the map.
+         *
+         * @param size
+         *     The width and height of the map in terms of the number of elements.
+         *
+         * @param diagonal
+         *     Allows the 4 diagonal moves in addition to W, E, N and S.
+        *******************************************************************************/
+        JumpPointSearch(const int* map = nullptr, int size = 0, bool diagonal = false);
+
+        /*!*****************************************************************************
+         * @brief Runs Jump Point Search to find the path from the starting position to the target position.
+         *
+         * @param starting
+         *     An array of 2 elements [j, i] representing the starting position on the map.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+         *
+         * @return
+         *     A vector of characters representing the path from the starting position to the target position.
+        *******************************************************************************/
+        std::vector<char> run(Key starting, Key target);
+
+        /*!*****************************************************************************
+         * @brief Runs Jump Point Search and writes the path into a reused vector.
+         *
+         * @param starting
+         *     An array of 2 elements [j, i] representing the starting position on the map.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+         *
+         * @param path
+         *     Receives the moves; left empty if the target cannot be reached.
+        *******************************************************************************/
+        void run(Key starting, Key target, std::vector<char>& path);
+
+        /*!*****************************************************************************
+         * @brief Returns the cost of the last path found, or -1 if there was none.
+        *******************************************************************************/
+        int getCost() const { return cost; }
+
+        /*!*****************************************************************************
+         * @brief Returns the number of jump points expanded by the last run.
+        *******************************************************************************/
+        std::size_t getExpanded() const { return expanded; }
+
+    private:
+
+        /*!*****************************************************************************
+         * @brief Checks that a cell is inside the map and empty.
+        *******************************************************************************/
+        bool walkable(int j, int i) const
+        {
+            return j >= 0 && j < size && i >= 0 && i < size && map[j * size + i] == 0;
+        }
+
+        /*!*****************************************************************************
+         * @brief Scans from a cell in one direction for the next jump point.
+         *
+         * @param j
+         *     Row of the first cell of the scan.
+         *
+         * @param i
+         *     Column of the first cell of the scan.
+         *
+         * @param dj
+         *     Vertical direction of the scan, -1, 0 or 1.
+         *
+         * @param di
+         *     Horizontal direction of the scan, -1, 0 or 1.
+         *
+         * @return
+         *     The jump point as j * size + i, or -1 if the scan hits an obstacle.
+        *******************************************************************************/
+        int jump(int j, int i, int dj, int di) const;
+
+        /*!*****************************************************************************
+         * @brief Lower bound of the cost from a cell to the goal.
+        *******************************************************************************/
+        int heuristic(int cell) const;
+
+        /*!*****************************************************************************
+         * @brief Invalidates the results of the previous query.
+        *******************************************************************************/
+        void nextGeneration();
+    };
+
+    // Admissible heuristics for grid keys [j, i], scaled by the cost of one
+    // straight step. A diagonal step costs 14 for a straight step of 10.
+
+    // Sum of the distances along the axes, exact on an empty 4-connected grid
+    struct Manhattan
+    {
+        int cost;
+
+        Manhattan(int cost = 10) : cost{ cost } {}
+
+        int operator()(const Key& a, const Key& b) const;
+    };
+
+    // Diagonal moves first and straight moves for the rest, exact on an empty
+    // 8-connected grid
+    struct Octile
+    {
+        int cost;
+
+        Octile(int cost = 10) : cost{ cost } {}
+
+        int operator()(const Key& a, const Key& b) const;
+    };
+
+    // Straight line distance, admissible for any movement on the plane
+    struct Euclidean
+    {
+        int cost;
+
+        Euclidean(int cost = 10) : cost{ cost } {}
+
+        int operator()(const Key& a, const Key& b) const;
+    };
+
+    // No estimate at all, which turns A* into Dijkstra's algorithm
+    struct Zero
+    {
+        int operator()(const Key&, const Key&) const { return 0; }
+    };
+
+    // A* search on the same GetAdjacents interface as Dijkstras. Nodes are
+    // ordered by f = g + h and ties go to the node with the higher g, which
+    // is the one closest to the target along its path.
+    // Type H defines the heuristic.
+    template<typename H = Manhattan>
+    class AStar
+    {
+        GetAdjacents* pGetAdjacents;
+        H heuristic;
+        IndexedHeap<> openlist;    // kept between runs so memory is reused
+        FlatHashTable<> closedlist;
+        std::size_t expanded;
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs an AStar object.
+         *
+         * @param pGetAdjacents
+         *     Pointer to a GetAdjacents object that provides the function to retrieve adjacent nodes.
+         *
+         * @param heuristic
+         *     Estimate of the remaining cost; it must never overestimate.
+        *******************************************************************************/
+        AStar(GetAdjacents* pGetAdjacents, H heuristic = H{})
+            : pGetAdjacents(pGetAdjacents), heuristic{ heuristic }
+            , openlist{}, closedlist{}, expanded{ 0 }
+        {
+        }
+
+        /*!*****************************************************************************
+         * @brief Runs A* to find the path from the starting position to the target position.
+         *
+         * @param starting
+         *     An array of 2 elements [j, i] representing the starting position on the map.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+         *
+         * @return
+         *     A vector of characters representing the path from the starting position to the target position.
+        *******************************************************************************/
+        std::vector<char> run(Key starting, Key target);
+
+        /*!*****************************************************************************
+         * @brief Returns the number of nodes expanded by the last run.
+        *******************************************************************************/
+        std::size_t getExpanded() const { return expanded; }
+    };
+
+    // D* Lite: incremental replanning on the GetAdjacents interface. The
+    // search runs from the target towards the start over the reverse
+    // adjacents and keeps its costs between runs. When cells change, only
+    // the nodes whose costs became inconsistent are queued again, so the work
+    // of a replan grows with the change rather than with the map. The agent
+    // may move along the path between runs; the key offset km keeps the
+    // queued priorities valid without reordering them.
+    // Type H defines the heuristic.
+    template<typename H = Manhattan>
+    class DStarLite
+    {
+        struct State
+        {
+            int g;   // cost to the target as of the last expansion
+            int rhs; // cost to the target through the best successor
+        };
+
+        static constexpr int INF = std::numeric_limits<int>::max() / 4;
+
+        GetAdjacents* pGetAdjacents;
+        H heuristic;
+        FlatMap<State> states;
+        IndexedHeap<> openlist; // inconsistent nodes ordered by (k1, k2)
+        Key start;
+        Key goal;
+        int km;
+        bool planned;
+        std::size_t expanded;
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs a DStarLite object.
+         *
+         * @param pGetAdjacents
+         *     Pointer to a GetAdjacents object that provides the adjacent and the reverse adjacent nodes.
+         *
+         * @param heuristic
+         *     Estimate of the remaining cost; it must never overestimate.
+        *******************************************************************************/
+        DStarLite(GetAdjacents* pGetAdjacents, H heuristic = H{})
+            : pGetAdjacents(pGetAdjacents), heuristic{ heuristic }
+            , states{}, openlist{}, start{}, goal{}, km{ 0 }, planned{ false }, expanded{ 0 }
+        {
+        }
+
+        /*!*****************************************************************************
+         * @brief Plans from the starting position, reusing the previous search if the target is the same.
+         *
+         * @param starting
+         *     An array of 2 elements [j, i] representing the current position of the agent.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+         *
+         * @return
+         *     A vector of characters representing the path from the starting position to the target position.
+        *******************************************************************************/
+        std::vector<char> run(Key starting, Key target);
+
+        /*!*****************************************************************************
+         * @brief Repairs the costs around cells whose edges changed; the next run replans.
+         *
+         * @param cells
+         *     The keys of the changed cells. Their reverse adjacents must include every
+         *     node whose edge into the cell was added, removed or changed in cost.
+        *******************************************************************************/
+        void mapChanged(const std::vector<Key>& cells);
+
+        /*!*****************************************************************************
+         * @brief Returns the number of nodes expanded by the last run.
+        *******************************************************************************/
+        std::size_t getExpanded() const { return expanded; }
+
+    private:
+
+        /*!*****************************************************************************
+         * @brief Returns the costs of a key, infinite for a key never seen.
+        *******************************************************************************/
+        State get(const Key& key) const
+        {
+            const State* state = states.find(key);
+            return state ? *state : State{ INF, INF };
+        }
+
+        /*!*****************************************************************************
+         * @brief Returns the costs of a key to change, added as infinite if new.
+        *******************************************************************************/
+        State& at(const Key& key)
+        {
+            State* state = states.find(key);
+            return state ? *state : (states[key] = State{ INF, INF });
+        }
+
+        /*!*****************************************************************************
+         * @brief Adds two costs, staying infinite once either one is.
+        *******************************************************************************/
+        static int add(int a, int b)
+        {
+            return std::min(a + b, INF);
+        }
+
+        /*!*****************************************************************************
+         * @brief Cheapest cost to the target through the successors of a key.
+        *******************************************************************************/
+        int bestSuccessor(const Key& key);
+
+        /*!*****************************************************************************
+         * @brief Queues, requeues or dequeues a key depending on whether it is consistent.
+        *******************************************************************************/
+        void updateVertex(const Key& key);
+
+        /*!*****************************************************************************
+         * @brief Expands inconsistent nodes until the cost of the start is known.
+        *******************************************************************************/
+        void computeShortestPath();
+    };
+
+    // A* that can be stopped and resumed, for callers that must not block for
+    // a whole search, such as a game that spends a fixed budget per frame.
+    // start() sets up a query and every step() expands nodes until a budget
+    // of expansions or a deadline runs out, like Backtracking::solve() does
+    // one step at a time. Between steps getPath() returns the path to the
+    // target once found, or to the closed node closest to the target by the
+    // heuristic. With the Zero heuristic the search is Dijkstra's algorithm
+    // and the partial path leads to the farthest node closed so far.
+    template<typename H = Zero>
+    class SlicedSearch
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Expansions between two reads of the clock in step(deadline)
+        static const std::size_t CLOCK_STRIDE = 16;
+
+        GetAdjacents* pGetAdjacents;
+        H heuristic;
+        IndexedHeap<> openlist;    // kept between queries so memory is reused
+        FlatHashTable<> closedlist;
+        Key target;
+        Node* pFound;   // the closed target, nullptr until it is reached
+        Node* pBest;    // closed node with the lowest estimate to the target
+        int bestH;
+        bool finished;
+        std::size_t expanded;
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs a SlicedSearch object.
+         *
+         * @param pGetAdjacents
+         *     Pointer to a GetAdjacents object that provides the function to retrieve adjacent nodes.
+         *
+         * @param heuristic
+         *     Estimate of the remaining cost; it must never overestimate.
+        *******************************************************************************/
+        SlicedSearch(GetAdjacents* pGetAdjacents, H heuristic = H{})
+            : pGetAdjacents(pGetAdjacents), heuristic{ heuristic }
+            , openlist{}, closedlist{}, target{}, pFound{ nullptr }, pBest{ nullptr }
+            , bestH{ 0 }, finished{ true }, expanded{ 0 }
+        {
+        }
+
+        /*!*****************************************************************************
+         * @brief Drops the current query and sets up a new one without expanding anything.
+         *
+         * @param starting
+         *     An array of 2 elements [j, i] representing the starting position on the map.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+        *******************************************************************************/
+        void start(Key starting, Key target);
+
+        /*!*****************************************************************************
+         * @brief Expands at most maxExpansions nodes of the current query.
+         *
+         * @param maxExpansions
+         *     The budget of expansions for this slice.
+         *
+         * @return
+         *     `true` once the search is finished, found or not, `false` if it needs more steps.
+        *******************************************************************************/
+        bool step(std::size_t maxExpansions);
+
+        /*!*****************************************************************************
+         * @brief Expands nodes of the current query until the deadline passes.
+         *
+         * @param deadline
+         *     The time by which the slice returns; at least one node is expanded.
+         *
+         * @return
+         *     `true` once the search is finished, found or not, `false` if it needs more steps.
+        *******************************************************************************/
+        bool step(Clock::time_point deadline);
+
+        /*!*****************************************************************************
+         * @brief Finds the path in a blocking mode.
+         *
+         * @param starting
+         *     An array of 2 elements [j, i] representing the starting position on the map.
+         *
+         * @param target
+         *     An array of 2 elements [j, i] representing the target position on the map.
+         *
+         * @return
+         *     A vector of characters representing the path from the starting position to the target position.
+        *******************************************************************************/
+        std::vector<char> run(Key starting, Key target);
+
+        /*!*****************************************************************************
+         * @brief Returns the path to the target, or the best partial path while it is not found.
+        *******************************************************************************/
+        std::vector<char> getPath() const;
+
+        /*!*****************************************************************************
+         * @brief Returns whether the search has finished.
+        *******************************************************************************/
+        bool isFinished() const { return finished; }
+
+        /*!*****************************************************************************
+         * @brief Returns whether the target has been reached.
+        *******************************************************************************/
+        bool isFound() const { return pFound != nullptr; }
+
+        /*!*****************************************************************************
+         * @brief Returns the number of nodes expanded since the query started.
+        *******************************************************************************/
+        std::size_t getExpanded() const { return expanded; }
+
+    private:
+
+        /*!*****************************************************************************
+         * @brief Closes the best open node and opens its adjacents.
+        *******************************************************************************/
+        void expand();
+    };
+
+    // Domain specific functor for the sliding puzzle on a width x width board.
+    // A key lists the tiles row by row with 0 for the blank, so it is a
+    // permutation of 0..n-1. A move slides the blank N, S, W or E and costs 1.
+    class GetPuzzleAdjacents : public GetAdjacents
+    {
+        int width; // tiles per row and per column
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs a GetPuzzleAdjacents object.
+         *
+         * @param width
+         *     The number of tiles per row; 3 for the 8-puzzle, 4 for the 15-puzzle.
+        *******************************************************************************/
+        GetPuzzleAdjacents(int width = 3)
+            : GetAdjacents(), width{ width }
+        {
+        }
+
+        /*!*****************************************************************************
+         * @brief Returns the states one move of the blank away.
+         *
+         * @param key
+         *     The tiles row by row, 0 for the blank.
+         *
+         * @return
+         *     A vector of pointers to AI::Node objects with the move of the blank as info.
+        *******************************************************************************/
+        std::vector<Node*> operator()(Key key);
+
+        /*!*****************************************************************************
+         * @brief Writes the states one move of the blank away without allocating nodes.
+         *
+         * @param key
+         *     The tiles row by row, 0 for the blank.
+         *
+         * @param list
+         *     The vector that receives the adjacent nodes, replacing its contents.
+        *******************************************************************************/
+        void adjacents(Key key, std::vector<Node>& list);
+
+        /*!*****************************************************************************
+         * @brief Returns the states one move away with the move that leads back to the key.
+         *
+         * @param key
+         *     The tiles row by row, 0 for the blank.
+         *
+         * @return
+         *     A vector of pointers to AI::Node objects whose moves lead into the key.
+        *******************************************************************************/
+        std::vector<Node*> reverse(Key key);
+
+        /*!*****************************************************************************
+         * @brief Returns the cost of one move.
+        *******************************************************************************/
+        int maxCost() const { return 1; }
+
+        /*!*****************************************************************************
+         * @brief Returns the number of tiles per row.
+        *******************************************************************************/
+        int getWidth() const { return width; }
+
+        /*!*****************************************************************************
+         * @brief Returns whether one state can be reached from the other.
+         *
+         * @param from
+         *     The first state.
+         *
+         * @param to
+         *     The second state.
+         *
+         * @return
+         *     `true` if the states are in the same half of the permutations.
+        *******************************************************************************/
+        bool solvable(const Key& from, const Key& to) const;
+
+        /*!*****************************************************************************
+         * @brief Perfect hash of a state: its index among all permutations in lexicographic order.
+         *
+         * @param key
+         *     A permutation of 0..n-1 with n up to 16.
+         *
+         * @return
+         *     The Lehmer code of the key read as a factorial base number, below n!.
+        *******************************************************************************/
+        static std::uint64_t rank(const Key& key);
+
+        /*!*****************************************************************************
+         * @brief Inverse of rank().
+         *
+         * @param index
+         *     A rank below n!.
+         *
+         * @param n
+         *     The number of elements in the permutation.
+         *
+         * @return
+         *     The permutation of 0..n-1 with the given rank.
+        *******************************************************************************/
+        static Key unrank(std::uint64_t index, int n);
+    };
+
+    // Breadth first search over sliding puzzle states. States are ranked
+    // with the perfect hash of GetPuzzleAdjacents, so the closed list is one
+    // bit per permutation and the move that reached a state is two more bits,
+    // 136 KB for the 8-puzzle; the open list holds ranks, not nodes. Moves
+    // all cost 1, so the first path found is a shortest one. The arrays have
+    // n! entries, which limits the solver to boards of up to 9 tiles.
+    class PuzzleSolver
+    {
+        GetPuzzleAdjacents getAdjacents;
+        std::vector<std::uint64_t> closed; // one bit per rank
+        std::vector<std::uint8_t> moves;   // two bits per rank, the move of the blank into it
+        std::vector<std::uint32_t> open;   // ranks in breadth first order
+        std::vector<Node> list;
+        std::size_t expanded;
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs a PuzzleSolver object.
+         *
+         * @param width
+         *     The number of tiles per row, at most 3.
+        *******************************************************************************/
+        PuzzleSolver(int width = 3)
+            : getAdjacents{ width }, closed{}, moves{}, open{}, list{}, expanded{ 0 }
+        {
+        }
+
+        /*!*****************************************************************************
+         * @brief Finds a shortest sequence of blank moves between two states.
+         *
+         * @param starting
+         *     The tiles row by row, 0 for the blank.
+         *
+         * @param target
+         *     The tiles row by row, 0 for the blank.
+         *
+         * @return
+         *     A vector of characters with the moves of the blank, empty if there is none.
+        *******************************************************************************/
+        std::vector<char> run(Key starting, Key target);
+
+        /*!*****************************************************************************
+         * @brief Visits every state reachable from a state.
+         *
+         * @param starting
+         *     The tiles row by row, 0 for the blank.
+         *
+         * @return
+         *     The number of reachable states, the starting one included.
+        *******************************************************************************/
+        std::size_t enumerate(Key starting);
+
+        /*!*****************************************************************************
+         * @brief Returns the number of states expanded by the last search.
+        *******************************************************************************/
+        std::size_t getExpanded() const { return expanded; }
+
+    private:
+
+        /*!*****************************************************************************
+         * @brief Searches until the target rank is closed or every state is visited.
+         *
+         * @param starting
+         *     The tiles row by row, 0 for the blank.
+         *
+         * @param target
+         *     The rank to stop at, or a value no state has to visit everything.
+         *
+         * @return
+         *     The number of states closed.
+        *******************************************************************************/
+        std::size_t search(const Key& starting, std::uint64_t target);
+    };
+
+    // Disjoint pattern database for the sliding puzzle with the blank last
+    // in the goal. For a group of tiles it stores the fewest moves of those
+    // tiles that bring them home from any placement, found by a breadth first
+    // search backwards from the goal in which moving any other tile is free.
+    // No move is counted by two groups, so the values of groups that split
+    // the tiles add up to an admissible estimate. An entry is one byte,
+    // indexed by the cells of the group's tiles ranked as a partial
+    // permutation: 524,160 bytes for 5 tiles of the 15-puzzle.
+    class PatternDatabase
+    {
+        int width;               // tiles per row and per column
+        std::vector<int> tiles;  // the group, in the order of the index digits
+        std::vector<std::uint8_t> owned; // the table when built or read
+        const std::uint8_t* table;       // owned or a mapped file
+        std::size_t entries;
+        void* mapping;           // the mapped file, nullptr if none
+        std::size_t mappedBytes;
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs an empty PatternDatabase object; build() or load() fills it.
+         *
+         * @param width
+         *     The number of tiles per row.
+         *
+         * @param tiles
+         *     The tiles of the group, numbered like in the keys.
+        *******************************************************************************/
+        PatternDatabase(int width, const std::vector<int>& tiles);
+
+        PatternDatabase(const PatternDatabase&) = delete;
+        PatternDatabase& operator=(const PatternDatabase&) = delete;
+
+        /*!*****************************************************************************
+         * @brief Releases the table, unmapping the file if it was mapped.
+        *******************************************************************************/
+        ~PatternDatabase();
+
+        /*!*****************************************************************************
+         * @brief Fills the table with a breadth first search backwards from the goal.
+        *******************************************************************************/
+        void build();
+
+        /*!*****************************************************************************
+         * @brief Builds several databases at the same time, one per thread.
+         *
+         * @param databases
+         *     The databases to build.
+         *
+         * @param threads
+         *     Number of worker threads, 0 uses one per hardware thread.
+        *******************************************************************************/
+        static void build(const std::vector<PatternDatabase*>& databases, unsigned threads = 0);
+
+        /*!*****************************************************************************
+         * @brief Writes the group and the table to a binary file.
+         *
+         * @param path
+         *     The file to write.
+         *
+         * @return
+         *     `true` if the whole file was written.
+        *******************************************************************************/
+        bool save(const std::string& path) const;
+
+        /*!*****************************************************************************
+         * @brief Maps a file written by save() for the same group, read only.
+         *
+         * @param path
+         *     The file to map. Where mmap is not available the file is read instead.
+         *
+         * @return
+         *     `true` if the file holds a table of this group.
+        *******************************************************************************/
+        bool load(const std::string& path);
+
+        /*!*****************************************************************************
+         * @brief Returns whether the table is built or loaded.
+        *******************************************************************************/
+        bool ready() const { return table != nullptr; }
+
+        /*!*****************************************************************************
+         * @brief Returns the tiles of the group.
+        *******************************************************************************/
+        const std::vector<int>& getTiles() const { return tiles; }
+
+        /*!*****************************************************************************
+         * @brief Returns the fewest moves of the group's tiles to bring them home.
+         *
+         * @param where
+         *     The cell of every tile, indexed by tile.
+         *
+         * @return
+         *     The table entry of the cells of the group's tiles.
+        *******************************************************************************/
+        int operator()(const int* where) const
+        {
+            return table[index(where)];
+        }
+
+    private:
+
+        /*!*****************************************************************************
+         * @brief Ranks the cells of the group's tiles as a partial permutation.
+         *
+         * @param where
+         *     The cell of every tile, indexed by tile.
+         *
+         * @return
+         *     The index of the table entry.
+        *******************************************************************************/
+        std::size_t index(const int* where) const;
+
+        /*!*****************************************************************************
+         * @brief Drops the table, unmapping the file if it was mapped.
+        *******************************************************************************/
+        void release();
+    };
+
+    // IDA* for the sliding puzzle with the sum of disjoint pattern databases
+    // as the heuristic. Each iteration is a depth first search bounded by
+    // f = g + h, and the next bound is the lowest f that went over. Nothing
+    // is stored but the current path, so memory stays linear in the depth.
+    // A move changes the cell of one tile, so only the database of that tile
+    // is read again. The goal is the one the databases were built for: the
+    // tiles in order with the blank last.
+    class PuzzleIDAStar
+    {
+        static const int FOUND = -1;
+
+        int width;
+        std::vector<const PatternDatabase*> databases;
+        std::vector<int> owner;   // database of every tile, -1 for none
+        std::vector<int> board;   // tile in every cell
+        std::vector<int> where;   // cell of every tile
+        std::vector<int> parts;   // current value of every database
+        std::vector<char> path;
+        std::size_t expanded;
+
+    public:
+
+        /*!*****************************************************************************
+         * @brief Constructs a PuzzleIDAStar object.
+         *
+         * @param width
+         *     The number of tiles per row.
+         *
+         * @param databases
+         *     Ready databases of disjoint groups of tiles.
+        *******************************************************************************/
+        PuzzleIDAStar(int width, const std::vector<const PatternDatabase*>& databases);
+
+        /*!*****************************************************************************
+         * @brief Finds a shortest sequence of blank moves to the goal.
+         *
+         * @param starting
+         *     The tiles row by row, 0 for the blank.
+         *
+         * @return
+         *     A vector of characters with the moves of the blank, empty if there is none.
+        *******************************************************************************/
+        std::vector<char> run(Key starting);
+
+        /*!*****************************************************************************
+         * @brief Returns the number of nodes expanded by the last run, over all iterations.
+        *******************************************************************************/
+        std::size_t getExpanded() const { return expanded; }
+
+    private:
+
+        /*!*****************************************************************************
+         * @brief Depth first search below a bound.
+         *
+         * @param blank
+         *     The cell of the blank.
+         *
+         * @param g
+         *     The cost so far.
+         *
+         * @param bound
+         *     The highest f searched in this iteration.
+         *
+         * @param back
+         *     The cell the blank came from, -1 at the root.
+         *
+         * @return
+         *     FOUND, or the lowest f over the bound.
+        *******************************************************************************/
+        int search(int blank, int g, int bound, int back);
+    };
+
+    // Landmark distances for ALT (A*, landmarks, triangle inequality) on a
+    // static GetMapAdjacents style grid. For every landmark L the moves d(L, x)
+    // to every cell x are stored, and |d(L, b) - d(L, a)| never exceeds the
+    // moves from a to b, so the largest one is an admissible estimate that
+    // sees around walls. Landmarks are picked one at a time as the cell
+    // farthest from the ones already picked, which puts them on the edges of
+    // the map where they bound the most queries. Every region of connected
+    // open cells large enough to matter gets landmarks of its own; queries in
+    // a region without any fall back to the Manhattan distance. Distances are
+    // two bytes per landmark and cell, stored cell by cell so an estimate
+    // reads one run.
+    class Landmarks
+    {
+        const int* map; // the map with integers where 0 means an empty cell
+        int size;       // width and height of the map in elements
+        std::vector<GridKey> landmarks;
+        std::vector<std::uint16_t> distances; // [cell * landmarks + landmark]
+
+    public:
+        // Distance of a cell the landmark cannot reach
+        static constexpr std::uint16_t UNREACHABLE = 0xFFFF;
+
+        /*!*****************************************************************************
+         * @brief Constructs a Landmarks object without landmarks.
+         *
+         * @param map
+         *     A pointer to an array of integers representing the map, 0 for an empty cell.
+         *
+         * @param size
+         *     The width and height of the map in terms of the number of elements.
+        *******************************************************************************/
+        Landmarks(const int* map = nullptr, int size = 0);
+
+        /*!*****************************************************************************
+         * @brief Picks landmarks by farthest point selection and fills their distances.
+         *
+         * @param count
+         *     The number of landmarks; fewer are picked if the map runs out of cells.
+        *******************************************************************************/
+        void build(int count);
+
+        /*!*****************************************************************************
+         * @brief Fills the distances of the current landmarks again, one landmark per thread.
+         *
+         * @param threads
+         *     Number of worker threads, 0 uses one per hardware thread.
+        *******************************************************************************/
+        void rebuild(unsigned threads = 0);
+
+        /*!*****************************************************************************
+         * @brief Writes the landmarks and their distances to a binary file.
+         *
+         * @param path
+         *     The file to write.
+         *
+         * @return
+         *     `true` if the whole file was written.
+        *******************************************************************************/
+        bool save(const std::string& path) const;
+
+        /*!*****************************************************************************
+         * @brief Reads a file written by save() for a map of the same size.
+         *
+         * @param path
+         *     The file to read.
+         *
+         * @return
+         *     `true` if the file holds landmarks of a map of this size.
+        *******************************************************************************/
+        bool load(const std::string& path);
+
+        /*!*****************************************************************************
+         * @brief Returns the landmark cells.
+        *******************************************************************************/
+        const std::vector<GridKey>& getLandmarks() const { return landmarks; }
+
+        /*!*****************************************************************************
+         * @brief Returns the moves between a landmark and a cell.
+         *
+         * @param landmark
+         *     The index of the landmark.
+         *
+         * @param cell
+         *     The cell [j, i].
+         *
+         * @return
+         *     The number of moves, or UNREACHABLE.
+        *******************************************************************************/
+        int distance(std::size_t landmark, const Key& cell) const;
+
+        /*!*****************************************************************************
+         * @brief Lower bound on the moves between two cells from the triangle inequality.
+         *
+         * @param a
+         *     The first cell [j, i].
+         *
+         * @param b
+         *     The second cell [j, i].
+         *
+         * @return
+         *     The largest difference of the distances of a landmark that reaches both,
+         *     0 without landmarks.
+        *******************************************************************************/
+        int estimate(const Key& a, const Key& b) const;
+
+    private:
+
+        /*!*****************************************************************************
+         * @brief Moves from a cell to every cell, by a breadth first search.
+         *
+         * @param from
+         *     The cell [j, i] to start from.
+         *
+         * @param table
+         *     Receives the moves of every cell, UNREACHABLE where there is no path.
+        *******************************************************************************/
+        void flood(const GridKey& from, std::vector<std::uint16_t>& table) const;
+
+        /*!*****************************************************************************
+         * @brief Stores the tables of all landmarks cell by cell.
+         *
+         * @param tables
+         *     The table of every landmark, in the order of the landmarks.
+        *******************************************************************************/
+        void interleave(const std::vector<std::vector<std::uint16_t>>& tables);
+    };
+
+    // Landmark estimate for AStar, or Manhattan where that is larger, as on
+    // open ground close to the target
+    struct LandmarkHeuristic
+    {
+        const Landmarks* landmarks;
+        int cost;
+
+        LandmarkHeuristic(const Landmarks* landmarks = nullptr, int cost = 10) : landmarks{ landmarks }, cost{ cost } {}
+
+        int operator()(const Key& a, const Key& b) const;
+    };
+
 } // end namespace
 
 #endif
\ No newline at end of file
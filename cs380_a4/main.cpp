@@ -1,6 +1,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <cstdio>
 #include "functions.h"
 
 void test0();
@@ -14,10 +15,31 @@ void test7();
 void test8();
 void test9();
 void test10();
+void test11();
+void test12();
+void test13();
+void test14();
+void test15();
+void test16();
+void test17();
+void test18();
+void test19();
+void test20();
+void test21();
+void test22();
+void test23();
+void test24();
+void test25();
+void test26();
+void test27();
+void test28();
+void test29();
+void test30();
+void test31();
 
 int main(int argc, char* argv[])
 {
-    void (*f[])() = { test1, test2, test3, test4, test5, test6, test7, test8, test9, test10 };
+    void (*f[])() = { test1, test2, test3, test4, test5, test6, test7, test8, test9, test10, test11, test12, test13, test14, test15, test16, test17, test18, test19, test20, test21, test22, test23, test24, test25, test26, test27, test28, test29, test30, test31 };
     const int SIZE = sizeof(f) / sizeof(f[0]);
     int id = -1;
 
@@ -427,3 +449,866 @@ void test10()
     else
         std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
 }
+
+void test11()
+{
+    AI::Node n1{{ }, 0, '1' };
+    AI::Node n2{{ }, 0, '2' };
+    AI::Node n3{{ }, 0, '3' };
+
+    AI::IndexedHeap q;
+    q.push(new AI::Node{{0, 0}, 3, 'S', &n1 });
+    q.push(new AI::Node{{1, 1}, 2, 'N', &n2 });
+    q.push(new AI::Node{{2, 2}, 5, 'E', &n3 });
+
+    AI::Node* found = q.find({ 2, 2 });
+    found->g = 1;
+    q.decrease(found, found->g);
+
+    std::ostringstream os;
+    while (!q.empty())
+    {
+        AI::Node* node = q.pop();
+        os << *node << "  ";
+        delete node;
+    }
+
+    std::string actual = os.str();
+    std::string expected = "2,2 1 E 3  1,1 2 N 2  0,0 3 S 1  ";
+
+    std::cout << "Test 11 : ";
+    if (actual == expected && q.find({ 2, 2 }) == nullptr)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Small weighted graph where the first path found to a node is not the best
+class GetGraphAdjacents : public AI::GetAdjacents
+{
+public:
+    std::vector<AI::Node*> operator()(AI::Key key)
+    {
+        std::vector<AI::Node*> list;
+        switch (key[0])
+        {
+        case 0:
+            list.push_back(new AI::Node{{ 1 }, 1, 'a' });
+            list.push_back(new AI::Node{{ 2 }, 5, 'b' });
+            break;
+        case 1:
+            list.push_back(new AI::Node{{ 2 }, 1, 'c' });
+            break;
+        case 2:
+            list.push_back(new AI::Node{{ 3 }, 1, 'd' });
+            break;
+        }
+        return list;
+    }
+};
+
+// Open map with scattered single walls, the same pattern for every size
+static std::vector<int> makeScatteredMap(int size)
+{
+    std::vector<int> map(size * size, 0);
+    for (int j = 0; j < size; ++j)
+        for (int i = 0; i < size; ++i)
+            if ((j * 7 + i * 13) % 5 == 0 && (j + i) % 3 != 0)
+                map[j * size + i] = 1;
+    return map;
+}
+
+// Replays the blank moves of a path with the domain and returns the final state
+static AI::Key replayMoves(AI::GetPuzzleAdjacents& getAdjacents, AI::Key state, const std::vector<char>& path)
+{
+    for (char move : path)
+    {
+        std::vector<AI::Node*> adjacents = getAdjacents(state);
+        for (AI::Node* adjacent : adjacents)
+        {
+            if (adjacent->info == move)
+                state = adjacent->key;
+            delete adjacent;
+        }
+    }
+    return state;
+}
+
+void test12()
+{
+    GetGraphAdjacents getAdjacents;
+
+    AI::Dijkstras dijkstras(&getAdjacents);
+
+    std::vector<char> path = dijkstras.run({ 0 }, { 3 });
+
+    std::ostringstream os;
+    os << path;
+
+    std::string actual = os.str();
+    std::string expected = "a,c,d";
+
+    std::cout << "Test 12 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Coordinates beyond one digit, searched twice with the same object
+void test13()
+{
+    const int size = 64;
+    std::vector<int> map(size * size, 0);
+
+    AI::GetMapAdjacents getAdjacents{ map.data(), size };
+
+    AI::Dijkstras dijkstras(&getAdjacents);
+
+    std::vector<char> path = dijkstras.run({ 0, 0 }, { size - 1, size - 1 });
+    std::vector<char> again = dijkstras.run({ 0, 0 }, { size - 1, size - 1 });
+
+    long east = std::count(path.begin(), path.end(), 'E');
+    long south = std::count(path.begin(), path.end(), 'S');
+
+    std::cout << "Test 13 : ";
+    if (path.size() == 2 * (size - 1) && east == size - 1 && south == size - 1 && path == again)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << path << ')' << std::endl;
+}
+
+void test14()
+{
+    AI::FlatHashTable table{ 4 };
+
+    table.add({ 1, 3, 2, 4, 5, 0, 7, 6, 8 }, new AI::Node{{1, 2}, 3, '4' });
+    table.add({ 1, 3, 2, 4, 5, 0, 7, 6, 8 }, new AI::Node{{5, 6}, 7, '8' }); // Reset
+    for (int j = 0; j < 100; ++j)
+        for (int i = 0; i < 100; ++i)
+            table.add({ j, i }, new AI::Node{{ j, i }, j + i, 'x' });
+
+    std::ostringstream os;
+    os << *table.find({ 1, 3, 2, 4, 5, 0, 7, 6, 8 }) << "  " << *table.find({ 99, 42 });
+    bool found = table.find({ 100, 0 }) == nullptr && table.size() == 10001;
+
+    table.clear();
+    bool cleared = table.find({ 99, 42 }) == nullptr && table.size() == 0;
+    table.add({ 99, 42 }, new AI::Node{{ 1, 1 }, 2, 'S' });
+    os << "  " << *table.find({ 99, 42 });
+
+    std::string actual = os.str();
+    std::string expected = "5,6 7 8  99,42 141 x  1,1 2 S";
+
+    std::cout << "Test 14 : ";
+    if (actual == expected && found && cleared)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+void test15()
+{
+    AI::Key a{ 8, 3, 2, 4, 5, 0, 7, 6, 1 };
+    AI::Key b{ 3, 2, 4, 5, 0, 7, 6, 1 };
+    int first = a.pop();
+    bool popped = first == 8 && a == b && a.hash() == b.hash();
+
+    AI::GridKey cell{ 7, 9 };
+    cell.set(1, 4);
+    bool changed = cell == AI::GridKey{ 7, 4 } && cell != AI::GridKey{ 4, 7 };
+
+    // Keys never drop elements silently
+    bool overflows = false;
+    try { AI::GridKey{ 1, 2, 3 }; } catch (const std::length_error&) { overflows = true; }
+    bool underflows = false;
+    try { AI::GridKey{}.pop(); } catch (const std::out_of_range&) { underflows = true; }
+
+    AI::FlatHashTable<AI::GridKey> table;
+    table.add({ 1, 2 }, new AI::BasicNode<AI::GridKey>{{ 1, 2 }, 3, '4' });
+
+    std::ostringstream os;
+    os << a << "  " << *table.find({ 1, 2 });
+
+    std::string actual = os.str();
+    std::string expected = "3,2,4,5,0,7,6,1  1,2 3 4";
+
+    std::cout << "Test 15 : ";
+    if (actual == expected && popped && changed && overflows && underflows && sizeof(AI::GridKey) <= 16 + sizeof(std::size_t))
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// A* finds the same cost as Dijkstras while expanding far fewer nodes
+void test16()
+{
+    const int size = 64;
+    std::vector<int> map(size * size, 0);
+    for (int j = 8; j < size; ++j)
+        map[j * size + size / 2] = 1; // wall with a gap at the top
+
+    AI::GetMapAdjacents getAdjacents{ map.data(), size };
+
+    AI::Dijkstras dijkstras(&getAdjacents);
+    AI::AStar<> astar(&getAdjacents);
+    AI::AStar<AI::Euclidean> euclidean(&getAdjacents);
+
+    std::vector<char> expected = dijkstras.run({ size - 1, 0 }, { size - 1, size - 1 });
+    std::vector<char> path = astar.run({ size - 1, 0 }, { size - 1, size - 1 });
+    std::vector<char> straight = euclidean.run({ size - 1, 0 }, { size - 1, size - 1 });
+
+    std::vector<int> open(size * size, 0);
+    AI::GetMapAdjacents getOpenAdjacents{ open.data(), size };
+    AI::AStar<> openAStar(&getOpenAdjacents);
+    std::vector<char> diagonal = openAStar.run({ 0, 0 }, { size - 1, size - 1 });
+
+    std::cout << "Test 16 : ";
+    if (path.size() == expected.size() && straight.size() == expected.size()
+        && diagonal.size() == 2 * (size - 1) && openAStar.getExpanded() < 4 * size)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << path << std::endl << openAStar.getExpanded() << ')' << std::endl;
+}
+
+// The dense grid solver agrees with Dijkstras over many queries on one object
+void test17()
+{
+    const int size = 48;
+    std::vector<int> map = makeScatteredMap(size);
+    map[0] = 0;
+
+    AI::GetMapAdjacents getAdjacents{ map.data(), size };
+    AI::Dijkstras dijkstras(&getAdjacents);
+    AI::GridDijkstras grid(map.data(), size);
+
+    std::vector<char> path;
+    path.reserve(size * size);
+    const char* buffer = path.data();
+
+    bool same = true;
+    for (int q = 0; q < 40; ++q)
+    {
+        AI::Key target{ (q * 17) % size, (q * 29) % size };
+        std::vector<char> expected = dijkstras.run({ 0, 0 }, target);
+        grid.run({ 0, 0 }, target, path);
+        same = same && path.size() == expected.size();
+    }
+
+    map[1] = map[size] = 1; // wall in the start
+    grid.run({ 0, 0 }, { size - 1, size - 1 }, path);
+
+    std::cout << "Test 17 : ";
+    if (same && path.empty() && path.data() == buffer)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << path << ')' << std::endl;
+}
+
+// Jump Point Search finds paths of the same cost as the grid solver
+void test18()
+{
+    const int size = 48;
+    std::vector<int> map = makeScatteredMap(size);
+
+    AI::GridDijkstras grid(map.data(), size);
+    AI::JumpPointSearch jps(map.data(), size);
+
+    bool same = true;
+    for (int q = 1; q < 40; ++q)
+    {
+        AI::Key target{ (q * 17) % size, (q * 29) % size };
+        std::vector<char> expected = grid.run({ 0, 0 }, target);
+        std::vector<char> path = jps.run({ 0, 0 }, target);
+        same = same && path.size() == expected.size()
+            && jps.getCost() == (expected.empty() ? -1 : 10 * static_cast<int>(expected.size()));
+    }
+
+    // One diagonal line across an empty map, written as N and E pairs
+    std::vector<int> open(size * size, 0);
+    AI::JumpPointSearch diagonal(open.data(), size, true);
+    std::vector<char> path = diagonal.run({ 3, 0 }, { 0, 3 });
+
+    std::ostringstream os;
+    os << path;
+
+    std::string actual = os.str();
+    std::string expected = "N,E,N,E,N,E";
+
+    std::cout << "Test 18 : ";
+    if (actual == expected && same && diagonal.getCost() == 42 && diagonal.getExpanded() == 1)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Searching from both ends finds an equally short path with about half the expansions
+void test19()
+{
+    const int size = 128;
+    std::vector<int> map(size * size, 0);
+
+    AI::GetMapAdjacents getAdjacents{ map.data(), size };
+    AI::Dijkstras dijkstras(&getAdjacents);
+    AI::BidirectionalDijkstras bidirectional(&getAdjacents);
+
+    std::vector<char> expected = dijkstras.run({ 64, 32 }, { 64, 95 });
+    std::vector<char> path = bidirectional.run({ 64, 32 }, { 64, 95 });
+    bool half = bidirectional.getExpanded() * 10 < dijkstras.getExpanded() * 6;
+
+    // Around a wall, the moves on the target side must keep their direction
+    for (int j = 0; j < size - 1; ++j)
+        map[j * size + 3] = 1;
+    std::vector<char> around = bidirectional.run({ 0, 0 }, { 0, 6 });
+
+    std::ostringstream os;
+    os << around;
+    std::string actual = os.str();
+
+    std::cout << "Test 19 : ";
+    if (path == expected && half && std::count(around.begin(), around.end(), 'S') == size - 1
+        && around.size() == 2 * (size - 1) + 6 && around.front() == 'E' && around.back() == 'E')
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// One field serves every agent and is rebuilt only when something changed
+void test20()
+{
+    const int size = 32;
+    std::vector<int> map(size * size, 0);
+    for (int j = 0; j < size - 1; ++j)
+        map[j * size + size / 2] = 1;
+
+    AI::GridDijkstras grid(map.data(), size);
+    AI::FlowField field(map.data(), size);
+
+    field.setTarget({ 0, size - 1 });
+    bool built = field.update() && !field.update();
+    field.setTarget({ 0, size - 1 });
+    bool kept = !field.update();
+
+    bool same = true;
+    for (int j = 0; j < size; ++j)
+        for (int i = 0; i < size; ++i)
+            if (map[j * size + i] == 0)
+            {
+                std::vector<char> expected = grid.run({ j, i }, { 0, size - 1 });
+                same = same && field.getPath({ j, i }).size() == expected.size()
+                    && field.getDistance({ j, i }) == 10 * static_cast<int>(expected.size());
+            }
+
+    // Open a gap at the top of the wall
+    map[size / 2] = 0;
+    field.mapChanged();
+    bool rebuilt = field.update();
+
+    std::ostringstream os;
+    os << field.getPath({ 0, size / 2 - 2 }) << "  " << field.getDistance({ 1, size / 2 }) << ' ' << int(field.next({ 0, size - 1 }));
+
+    std::string actual = os.str();
+    std::string expected = "E,E,E,E,E,E,E,E,E,E,E,E,E,E,E,E,E  -1 0";
+
+    std::cout << "Test 20 : ";
+    if (actual == expected && built && kept && same && rebuilt)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Batch queries on a persistent pool return the serial paths in input order
+void test21()
+{
+    const int size = 48;
+    std::vector<int> map = makeScatteredMap(size);
+
+    AI::GetMapAdjacents getAdjacents{ map.data(), size };
+    AI::Dijkstras dijkstras(&getAdjacents);
+    AI::BatchDijkstras batch(&getAdjacents, 4);
+
+    std::vector<std::pair<AI::Key, AI::Key>> queries;
+    for (int q = 0; q < 200; ++q)
+        queries.emplace_back(AI::Key{ (q * 5) % size, (q * 11) % size }, AI::Key{ (q * 17) % size, (q * 29) % size });
+
+    std::vector<std::vector<char>> paths = batch.run(queries);
+    std::vector<std::vector<char>> again = batch.run(queries);
+
+    bool same = paths.size() == queries.size() && paths == again && batch.getThreads() == 4;
+    for (std::size_t q = 0; q < queries.size() && same; ++q)
+        same = paths[q] == dijkstras.run(queries[q].first, queries[q].second);
+
+    // Many small batches on the same workers, fewer queries than threads
+    for (std::size_t q = 0; q < queries.size() && same; ++q)
+        same = batch.run({ queries[q] }).front() == paths[q];
+
+    std::cout << "Test 21 : ";
+    if (same && batch.run({}).empty())
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << paths.front() << ')' << std::endl;
+}
+
+// Repeated queries come from the cache, edits drop only the paths they touch
+void test22()
+{
+    const int size = 16;
+    std::vector<int> map(size * size, 0);
+
+    AI::GetMapAdjacents getAdjacents{ map.data(), size };
+    AI::PathCache cache(&getAdjacents, 2);
+
+    std::vector<char> top = cache.run({ 0, 0 }, { 0, 5 });
+    std::vector<char> bottom = cache.run({ 9, 0 }, { 9, 5 });
+    bool hit = cache.run({ 0, 0 }, { 0, 5 }) == top && cache.getHits() == 1 && cache.getMisses() == 2;
+
+    // The top row is blocked at 3, only the path along it is dropped
+    map[3] = 1;
+    cache.mapChanged({ { 0, 3 } });
+    bool kept = cache.size() == 1 && cache.run({ 9, 0 }, { 9, 5 }) == bottom && cache.getHits() == 2;
+    std::vector<char> around = cache.run({ 0, 0 }, { 0, 5 });
+
+    // A third path evicts the least recently used one, which is the bottom row
+    cache.run({ 5, 5 }, { 5, 7 });
+    cache.run({ 9, 0 }, { 9, 5 });
+    bool evicted = cache.getMisses() == 5 && cache.size() == 2;
+
+    std::ostringstream os;
+    os << around;
+
+    std::string actual = os.str();
+    std::string expected = "E,E,S,E,E,E,N";
+
+    std::cout << "Test 22 : ";
+    if (actual == expected && hit && kept && evicted)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// The hierarchical search stays close to the shortest path and follows map edits
+void test23()
+{
+    const int size = 64;
+    std::vector<int> map = makeScatteredMap(size);
+
+    AI::GridDijkstras grid(map.data(), size);
+    AI::HPAStar hpa(map.data(), size, 8);
+
+    bool close = true;
+    for (int q = 1; q < 40; ++q)
+    {
+        AI::Key start{ (q * 5) % size, (q * 11) % size };
+        AI::Key target{ (q * 17) % size, (q * 29) % size };
+        if (map[start[0] * size + start[1]] != 0)
+            continue;
+        std::vector<char> expected = grid.run(start, target);
+        std::vector<char> path = hpa.run(start, target);
+        close = close && path.empty() == expected.empty() && path.size() * 4 <= expected.size() * 5;
+    }
+
+    // Wall off the middle row except for one gap on the far right
+    std::vector<AI::Key> edited;
+    for (int i = 0; i < size - 1; ++i)
+    {
+        map[32 * size + i] = 1;
+        edited.push_back({ 32, i });
+    }
+    map[32 * size + size - 1] = 0;
+    hpa.mapChanged(edited);
+
+    std::vector<char> expected = grid.run({ 31, 0 }, { 33, 0 });
+    std::vector<char> path = hpa.run({ 31, 0 }, { 33, 0 });
+    AI::HPAStar fresh(map.data(), size, 8);
+
+    std::cout << "Test 23 : ";
+    if (close && path == fresh.run({ 31, 0 }, { 33, 0 }) && !path.empty()
+        && path.size() * 4 <= expected.size() * 5 && std::count(path.begin(), path.end(), 'E') >= size - 1)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << path << ')' << std::endl;
+}
+
+// The agent keeps its search while it walks and repairs it when a cell closes
+void test24()
+{
+    const int size = 32;
+    std::vector<int> map(size * size, 0);
+    for (int j = 0; j < size; ++j)
+        map[j * size + size / 2] = 1;
+    map[24 * size + size / 2] = 0;
+
+    AI::GetMapAdjacents getAdjacents{ map.data(), size };
+    AI::Dijkstras dijkstras(&getAdjacents);
+    AI::DStarLite<> dstar(&getAdjacents);
+
+    AI::Key target{ 0, size - 1 };
+    std::vector<char> first = dstar.run({ 0, 0 }, target);
+    bool planned = first.size() == dijkstras.run({ 0, 0 }, target).size();
+
+    // Walk a few moves, then block the cell two moves ahead
+    AI::Key cells[8]{ { 0, 0 } };
+    for (int k = 1; k < 8; ++k)
+    {
+        AI::Key cell = cells[k - 1];
+        char move = first[k - 1];
+        cells[k] = AI::Key{ cell[0] + (move == 'S') - (move == 'N'), cell[1] + (move == 'E') - (move == 'W') };
+    }
+    map[cells[7][0] * size + cells[7][1]] = 1;
+    dstar.mapChanged({ cells[7] });
+
+    std::vector<char> path = dstar.run(cells[5], target);
+    std::size_t repaired = dstar.getExpanded();
+    std::vector<char> expected = dijkstras.run(cells[5], target);
+
+    AI::DStarLite<> fresh(&getAdjacents);
+    std::vector<char> replanned = fresh.run(cells[5], target);
+
+    std::cout << "Test 24 : ";
+    if (planned && !path.empty() && path.size() == expected.size() && replanned.size() == expected.size()
+        && repaired * 4 < fresh.getExpanded())
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << path << ')' << std::endl;
+}
+
+// Grid where entering a cell costs 1 to 9, with or without telling the bound
+class GetWeightedAdjacents : public AI::GetAdjacents
+{
+public:
+    static const int SIZE = 48;
+    bool bounded;
+
+    GetWeightedAdjacents(bool bounded) : bounded{ bounded } {}
+
+    static int cost(int j, int i) { return 1 + (j * 7 + i * 3 + j * i) % 9; }
+
+    std::vector<AI::Node*> operator()(AI::Key key)
+    {
+        std::vector<AI::Node*> list;
+        int j = key[0];
+        int i = key[1];
+        if (i > 0)        list.push_back(new AI::Node{{ j, i - 1 }, cost(j, i - 1), 'W' });
+        if (i < SIZE - 1) list.push_back(new AI::Node{{ j, i + 1 }, cost(j, i + 1), 'E' });
+        if (j > 0)        list.push_back(new AI::Node{{ j - 1, i }, cost(j - 1, i), 'N' });
+        if (j < SIZE - 1) list.push_back(new AI::Node{{ j + 1, i }, cost(j + 1, i), 'S' });
+        return list;
+    }
+
+    int maxCost() const { return bounded ? 9 : 0; }
+};
+
+// Bucket queue and heap give paths of the same cost when a node gets cheaper
+void test25()
+{
+    GetGraphAdjacents graph;
+    GetWeightedAdjacents heapGrid(false);
+    GetWeightedAdjacents bucketGrid(true);
+
+    AI::Dijkstras heap(&heapGrid);
+    AI::Dijkstras buckets(&bucketGrid);
+
+    auto total = [](AI::Key at, const std::vector<char>& path)
+    {
+        int sum = 0;
+        for (char move : path)
+        {
+            at = AI::Key{ at[0] + (move == 'S') - (move == 'N'), at[1] + (move == 'E') - (move == 'W') };
+            sum += GetWeightedAdjacents::cost(at[0], at[1]);
+        }
+        return sum;
+    };
+
+    bool same = true;
+    for (int q = 0; q < 20; ++q)
+    {
+        AI::Key start{ (q * 5) % 48, (q * 11) % 48 };
+        AI::Key target{ (q * 17 + 3) % 48, (q * 29 + 7) % 48 };
+        std::vector<char> expected = heap.run(start, target);
+        std::vector<char> path = buckets.run(start, target);
+        same = same && total(start, path) == total(start, expected);
+    }
+
+    // The first path found to node 2 costs 5 and is lowered to 2
+    class Bounded : public GetGraphAdjacents
+    {
+    public:
+        int maxCost() const { return 5; }
+    } bounded;
+    AI::Dijkstras small(&bounded);
+
+    std::ostringstream os;
+    os << small.run({ 0 }, { 3 });
+
+    std::string actual = os.str();
+    std::string expected = "a,c,d";
+
+    std::cout << "Test 25 : ";
+    if (actual == expected && same)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// A search spread over slices finds the same path as a blocking one
+void test26()
+{
+    const int size = 64;
+    std::vector<int> map(size * size, 0);
+    for (int j = 0; j < size - 1; ++j)
+        map[j * size + size / 2] = 1;
+
+    AI::GetMapAdjacents getAdjacents{ map.data(), size };
+    AI::AStar<> astar(&getAdjacents);
+    AI::Dijkstras dijkstras(&getAdjacents);
+    AI::SlicedSearch<AI::Manhattan> sliced(&getAdjacents);
+    AI::SlicedSearch<> slicedDijkstras(&getAdjacents);
+
+    AI::Key starting{ 0, 0 };
+    AI::Key target{ 0, size - 1 };
+
+    sliced.start(starting, target);
+    int slices = 0;
+    bool bounded = true;
+    bool closer = true;
+    std::size_t last = 0;
+    int lastDistance = 2 * size;
+    while (!sliced.step(100))
+    {
+        ++slices;
+        bounded = bounded && sliced.getExpanded() - last <= 100;
+        last = sliced.getExpanded();
+
+        // The partial path leads somewhere no farther from the target
+        AI::Key at = starting;
+        for (char move : sliced.getPath())
+            at = AI::Key{ at[0] + (move == 'S') - (move == 'N'), at[1] + (move == 'E') - (move == 'W') };
+        int distance = std::abs(at[0] - target[0]) + std::abs(at[1] - target[1]);
+        closer = closer && distance <= lastDistance && map[at[0] * size + at[1]] == 0;
+        lastDistance = distance;
+    }
+
+    // A deadline in the past still makes progress
+    slicedDijkstras.start(starting, target);
+    slicedDijkstras.step(std::chrono::steady_clock::now());
+    bool progress = slicedDijkstras.getExpanded() > 0 && !slicedDijkstras.isFinished();
+    while (!slicedDijkstras.step(std::chrono::steady_clock::now() + std::chrono::microseconds(200))) {
+    }
+
+    std::vector<char> path = sliced.getPath();
+
+    std::cout << "Test 26 : ";
+    if (sliced.isFound() && slices > 10 && bounded && closer && progress && lastDistance < size / 4
+        && path == astar.run(starting, target)
+        && slicedDijkstras.getPath().size() == dijkstras.run(starting, target).size())
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << path << ')' << std::endl;
+}
+
+// Pooled nodes stay in place while the pool grows and are reused after a reset
+void test27()
+{
+    AI::NodePool<> pool;
+    std::vector<AI::Node*> nodes;
+    for (int k = 0; k < 10000; ++k)
+        nodes.push_back(pool.make({ k }, k, 'a', k ? nodes.back() : nullptr));
+
+    bool kept = pool.size() == 10000;
+    for (int k = 0; k < 10000; ++k)
+        kept = kept && nodes[k]->key[0] == k && nodes[k]->g == k && (k == 0 || nodes[k]->parent == nodes[k - 1]);
+
+    pool.reset();
+    bool reused = pool.make({ 7 }) == nodes[0] && pool.size() == 1;
+
+    // The default hook copies what operator() returns, in the same order
+    std::vector<int> map(9, 0);
+    map[1] = 1;
+    AI::GetMapAdjacents getAdjacents{ map.data(), 3 };
+    GetGraphAdjacents graph;
+    std::vector<AI::Node> list;
+
+    std::ostringstream os;
+    getAdjacents.adjacents({ 1, 1 }, list);
+    for (const AI::Node& node : list)
+        os << node.info;
+    graph.adjacents({ 0 }, list);
+    for (const AI::Node& node : list)
+        os << node.info << node.g;
+
+    std::string actual = os.str();
+    std::string expected = "WESa1b5";
+
+    std::cout << "Test 27 : ";
+    if (actual == expected && kept && reused)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// The hardest 8-puzzle takes 31 moves and half of all states are reachable
+void test28()
+{
+    AI::Key start{ 8, 6, 7, 2, 5, 4, 3, 0, 1 };
+    AI::Key goal{ 1, 2, 3, 4, 5, 6, 7, 8, 0 };
+
+    AI::PuzzleSolver solver;
+    std::vector<char> path = solver.run(start, goal);
+
+    AI::GetPuzzleAdjacents getAdjacents;
+    AI::Key state = replayMoves(getAdjacents, start, path);
+
+    bool ranked = true;
+    for (std::uint64_t index : { 0ull, 1ull, 12345ull, 362879ull })
+        ranked = ranked && AI::GetPuzzleAdjacents::rank(AI::GetPuzzleAdjacents::unrank(index, 9)) == index;
+
+    std::size_t reachable = solver.enumerate(goal);
+    bool unsolvable = solver.run({ 2, 1, 3, 4, 5, 6, 7, 8, 0 }, goal).empty() && solver.getExpanded() == 0;
+
+    std::cout << "Test 28 : ";
+    if (path.size() == 31 && state == goal && ranked && reachable == 181440 && unsolvable
+        && AI::GetPuzzleAdjacents::rank(goal) == 46233)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << path << ')' << std::endl;
+}
+
+// IDA* with additive pattern databases solves a 15-puzzle in the fewest moves
+void test29()
+{
+    AI::PatternDatabase a(4, { 1, 2, 3 }), b(4, { 4, 5, 6 }), c(4, { 7, 8, 9 });
+    AI::PatternDatabase d(4, { 10, 11, 12 }), e(4, { 13, 14, 15 });
+    AI::PatternDatabase::build({ &a, &b, &c, &d, &e }, 2);
+
+    // A saved table maps back with the same entries, but only for its own group
+    AI::PatternDatabase mapped(4, { 1, 2, 3 }), other(4, { 1, 2, 4 });
+    bool saved = a.save("test29.pdb");
+    bool loaded = saved && mapped.load("test29.pdb") && !other.load("test29.pdb");
+    std::remove("test29.pdb");
+
+    int where[16];
+    bool same = true;
+    for (int k = 0; k < 200; ++k)
+    {
+        for (int t = 0; t < 16; ++t)
+            where[t] = (t * 7 + k * 3) % 16;
+        same = same && mapped(where) == a(where);
+    }
+
+    AI::PuzzleIDAStar ida(4, { &mapped, &b, &c, &d, &e });
+    AI::Key start{ 10, 2, 3, 7, 5, 1, 11, 8, 13, 4, 6, 12, 14, 15, 9, 0 };
+    std::vector<char> path = ida.run(start);
+
+    AI::GetPuzzleAdjacents getAdjacents{ 4 };
+    AI::Key state = replayMoves(getAdjacents, start, path);
+    AI::Key goal{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0 };
+
+    std::cout << "Test 29 : ";
+    if (path.size() == 36 && state == goal && loaded && same
+        && ida.run({ 2, 1, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0 }).empty())
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << path << ')' << std::endl;
+}
+
+// Search counters are filled in when compiled in and stay zero otherwise
+void test30()
+{
+    const int size = 32;
+    std::vector<int> map(size * size, 0);
+    for (int j = 1; j < size; ++j)
+        map[j * size + size / 2] = 1;
+
+    AI::GetMapAdjacents getAdjacents{ map.data(), size };
+    AI::Dijkstras dijkstras(&getAdjacents);
+    std::vector<char> path = dijkstras.run({ size - 1, 0 }, { size - 1, size - 1 });
+    AI::SearchStats mapStats = dijkstras.getStats();
+
+    GetGraphAdjacents graph;
+    AI::Dijkstras small(&graph);
+    small.run({ 0 }, { 3 });
+    AI::SearchStats graphStats = small.getStats();
+
+    bool counted;
+    if (AI::SearchStats::ENABLED)
+        counted = mapStats.expanded == dijkstras.getExpanded() && mapStats.closed == mapStats.expanded + 1
+            && mapStats.generated >= 2 * mapStats.expanded && mapStats.generated <= 4 * mapStats.expanded
+            && mapStats.peakOpen > 0 && mapStats.peakOpen < mapStats.closed
+            && mapStats.searchSeconds >= 0.0 && mapStats.pathSeconds >= 0.0
+            && graphStats.decreased == 1 && graphStats.generated == 4;
+    else
+        counted = mapStats.expanded == 0 && mapStats.generated == 0 && mapStats.closed == 0
+            && mapStats.peakOpen == 0 && graphStats.decreased == 0 && mapStats.searchSeconds == 0.0;
+
+    std::cout << "Test 30 : ";
+    if (counted && path.size() == static_cast<std::size_t>(3 * (size - 1)))
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << path << ')' << std::endl;
+}
+
+// Landmarks see around walls that fool the Manhattan distance
+void test31()
+{
+    // A wall down the middle with the only gap at the bottom
+    const int size = 64;
+    std::vector<int> map(size * size, 0);
+    for (int j = 0; j < size - 1; ++j)
+        map[j * size + size / 2] = 1;
+
+    AI::Landmarks landmarks(map.data(), size);
+    landmarks.build(8);
+
+    AI::Landmarks loaded(map.data(), size);
+    bool saved = landmarks.save("test31.alt") && loaded.load("test31.alt");
+    std::remove("test31.alt");
+
+    // Tables filled again on several threads match the ones from selection
+    bool same = saved && landmarks.getLandmarks().size() == 8;
+    AI::Landmarks copy(map.data(), size);
+    copy.build(8);
+    copy.rebuild(3);
+    for (std::size_t l = 0; l < 8 && same; ++l)
+        for (int c = 0; c < size * size; ++c)
+            same = same && copy.distance(l, { c / size, c % size }) == loaded.distance(l, { c / size, c % size });
+
+    AI::GetMapAdjacents getAdjacents{ map.data(), size };
+    AI::GridDijkstras grid(map.data(), size);
+    AI::AStar<> manhattan(&getAdjacents);
+    AI::AStar<AI::LandmarkHeuristic> alt(&getAdjacents, AI::LandmarkHeuristic{ &loaded });
+
+    std::size_t fewer = 0;
+    bool shortest = true;
+    for (int q = 0; q < 8; ++q)
+    {
+        AI::Key start{ q, size / 2 - 1 - q * 3 };
+        AI::Key target{ q * 2, size / 2 + 1 + q * 2 };
+        std::vector<char> expected = grid.run(start, target);
+        std::vector<char> path = alt.run(start, target);
+        manhattan.run(start, target);
+        shortest = shortest && !path.empty() && path.size() == expected.size();
+        fewer += alt.getExpanded() * 4 < manhattan.getExpanded();
+    }
+
+    // Both halves of a split map get landmarks, and queries still work without any
+    std::vector<int> split(size * size, 0);
+    for (int j = 0; j < size; ++j)
+        split[j * size + size / 2] = 1;
+    AI::Landmarks halves(split.data(), size);
+    halves.build(4);
+    int left = 0;
+    for (const AI::GridKey& landmark : halves.getLandmarks())
+        left += landmark[1] < size / 2;
+
+    AI::Landmarks none(split.data(), size);
+    AI::GetMapAdjacents splitAdjacents{ split.data(), size };
+    AI::AStar<AI::LandmarkHeuristic> blind(&splitAdjacents, AI::LandmarkHeuristic{ &none });
+    bool regions = left > 0 && left < 4 && halves.getLandmarks().size() == 4
+        && blind.run({ 0, 0 }, { 5, 7 }).size() == 12 && none.estimate({ 0, 0 }, { 5, 7 }) == 0;
+
+    std::cout << "Test 31 : ";
+    if (same && shortest && fewer == 8 && regions)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << fewer << ')' << std::endl;
+}